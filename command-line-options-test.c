@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <fcntl.h>  // for open
 #include "ibarland-utils.h"
 
 #include "command-line-options.h"
@@ -14,8 +15,7 @@
 #include "command-line-options.c" 
 // (So DON'T link against command-line-options.o.)
 
-void test1(){
-    printf("\nTesting extractLongOptionName.\n");
+TEST_CASE(extractLongOptionName) {
     testStr( extractLongOptionName("--hello"), "hello" );
     testStr( extractLongOptionName("noLeadingDashes"), NULL );
     testStr( extractLongOptionName("-hello"), NULL );
@@ -25,8 +25,7 @@ void test1(){
     testStr( extractLongOptionName(NULL), NULL );
     }
 
-void test2(){
-    printf("\nTesting extractShortOptionName.\n");
+TEST_CASE(extractShortOptionName) {
     testChar( extractShortOptionName("-h"), 'h');
     testChar( extractShortOptionName("h"), '\0');
     testChar( extractShortOptionName("hello"), '\0');
@@ -40,8 +39,7 @@ void test2(){
 
 
 
-void test3() {
-    printf("\nTesting findOption.\n");
+TEST_CASE(findOption) {
     stringConst sample1[] = { "--hello","tag", "-b","99", "--", "--hello", "tag2" } ;
     stringConst sample2[] = { "--hello","tag", "-b","99", "--hello", "tag2" } ;
     struct option_info options[] = {
@@ -54,8 +52,7 @@ void test3() {
     }
 
 
-void test4() {
-    printf("\nTesting apparentOptionIsLegal.\n");
+TEST_CASE(apparentOptionIsLegal) {
     struct option_info options[] = {
         { "name", 'n', "ibarland", "the name of the package-author" },
         { "size", 's', "45", "the size of the frobzat, in meters." },
@@ -71,11 +68,109 @@ void test4() {
     testBool( apparentOptionIsLegal( numOpts, options, "--" ), true );
     }
 
+/* Run allOptions, setting *vals to its result, and returning (in buf) whatever it warned on stderr. */
+static const char* allOptionsWarnings( int argc, stringConst argv[], int numOptions, struct option_info options[],
+                                       stringConst** vals, char* buf, size_t cap ) {
+    FILE* captured = tmpfile();
+    fflush(stderr);
+    int const savedStderr = dup(STDERR_FILENO);
+    dup2(fileno(captured), STDERR_FILENO);
+    *vals = allOptions( argc, argv, numOptions, options );
+    fflush(stderr);
+    dup2(savedStderr, STDERR_FILENO);
+    close(savedStderr);
+    rewind(captured);
+    size_t const n = fread(buf, 1, cap-1, captured);
+    buf[n] = '\0';
+    fclose(captured);
+    return buf;
+    }
+
+TEST_CASE(allOptions) {
+    struct option_info options[] = {
+        { "name", 'n', "ibarland", "the name of the package-author" },
+        { "size", 's', "45", "the size of the frobzat, in meters." },
+        { "quiet", '\0', NULL, "no short form" },
+        };
+    stringConst argv1[] = { "prog", "--size", "27", "-n", "someone", "--quiet", "yes", "-s", "28" };
+    stringConst* vals = allOptions( SIZEOF_ARRAY(argv1), argv1, SIZEOF_ARRAY(options), options );
+    testStr( vals[0], "someone" );
+    testStr( vals[1], "28" );  // the last one wins
+    testStr( vals[2], "yes" );
+    free((void*)vals);
+    stringConst argv2[] = { "prog", "--", "--size", "27" };
+    vals = allOptions( SIZEOF_ARRAY(argv2), argv2, SIZEOF_ARRAY(options), options );
+    testStr( vals[0], "ibarland" );
+    testStr( vals[1], "45" );
+    testStr( vals[2], NULL );
+    free((void*)vals);
+
+    // A value that looks like an option is still just the value -- but it's still checked, too:
+    stringConst argv3[] = { "prog", "--name", "--bogus" };
+    char warnings[300];
+    testStr( allOptionsWarnings( SIZEOF_ARRAY(argv3), argv3, SIZEOF_ARRAY(options), options, &vals, warnings, sizeof(warnings) ),
+             "Warning: argument #2, \"--bogus\", is not a known option.\n" );
+    testStr( vals[0], "--bogus" );
+    free((void*)vals);
+    // Each option is matched on its own:  quiet takes "--name" as its value, but name still gets matched.
+    stringConst argv4[] = { "prog", "--quiet", "--name", "x" };
+    testStr( allOptionsWarnings( SIZEOF_ARRAY(argv4), argv4, SIZEOF_ARRAY(options), options, &vals, warnings, sizeof(warnings) ), "" );
+    testStr( vals[0], "x" );
+    testStr( vals[2], "--name" );
+    free((void*)vals);
+    stringConst argv5[] = { "prog", "-s", "3", "--size" };
+    testStr( allOptionsWarnings( SIZEOF_ARRAY(argv5), argv5, SIZEOF_ARRAY(options), options, &vals, warnings, sizeof(warnings) ),
+             "Warning: last argument, #3, \"--size\", has no provided value.\n"
+             "(Such args are not yet supported in ibarland's command-line-options, sorry.)\n" );
+    testStr( vals[1], "3" );
+    free((void*)vals);
+    // And in general, allOptions agrees with findOption on every option -- for all sorts of (odd) argvs:
+    stringConst words[] = { "--name", "-n", "--size", "-s", "--quiet", "--", "x", "y" };
+    rngState rng;
+    rng_seed(&rng, 7);
+    bool allAgree = true;
+    fflush(stderr);
+    int const savedStderr = dup(STDERR_FILENO);
+    int const devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDERR_FILENO);  // (plenty of these argvs get warned about)
+    for (int trial=0;  trial<3000;  ++trial) {
+        const char* argvRand[8] = { "prog" };
+        int const argcRand = 1 + (int)rng_below(&rng, 8);
+        for (int k=1;  k<argcRand;  ++k) { argvRand[k] = words[rng_below(&rng, SIZEOF_ARRAY(words))]; }
+        vals = allOptions( argcRand, argvRand, SIZEOF_ARRAY(options), options );
+        for (uint j=0;  j<SIZEOF_ARRAY(options);  ++j) {
+            allAgree = allAgree && vals[j] == findOption( options[j], argcRand, argvRand );
+            }
+        free((void*)vals);
+        }
+    fflush(stderr);
+    dup2(savedStderr, STDERR_FILENO);
+    close(savedStderr);
+    close(devNull);
+    testBool( allAgree, true );
+
+    // Hundreds of options:
+    #define MANY_OPTIONS 500
+    struct option_info many[MANY_OPTIONS];
+    char names[MANY_OPTIONS][16];
+    char flags[MANY_OPTIONS][20];
+    for (int i=0;  i<MANY_OPTIONS;  ++i) {
+        sprintf(names[i], "opt%d", i);
+        sprintf(flags[i], "--opt%d", i);
+        struct option_info const opt = { names[i], '\0', "default", "" };
+        memcpy( &many[i], &opt, sizeof(opt) );  // (the fields are const, so no assigning)
+        }
+    stringConst argvMany[] = { "prog", flags[499], "last", flags[0], "first", flags[250], "middle" };
+    vals = allOptions( SIZEOF_ARRAY(argvMany), argvMany, MANY_OPTIONS, many );
+    testStr( vals[0], "first" );
+    testStr( vals[250], "middle" );
+    testStr( vals[499], "last" );
+    testStr( vals[1], "default" );
+    free((void*)vals);
+    }
+
 int main ( void ) {
-    test1();
-    test2();
-    test3();
-    test4();
+    runTestCases(0, NULL);
     printTestSummary();
     }
 
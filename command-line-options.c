@@ -9,9 +9,15 @@
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <limits.h>
 #include "ibarland-utils.h"
 #include "command-line-options.h"
 
+/* Long option-names -- interned, so hashed and compared as just pointers -- to their index in the options[] array. */
+static ulong internedHash( stringConst s ) { return ulongHash( (ulong)(uintptr_t)s ); }
+DECLARE_HASHMAP(optionNameMap, const char*, int)
+DEFINE_HASHMAP(optionNameMap, const char*, int, internedHash, streq_interned)
+
 
   
 
@@ -88,6 +94,29 @@ bool apparentOptionIsLegal( int numOptions, struct option_info options[], string
 
 
 
+/* Which option does `arg` name -- as its index in options[] (using the maps made by allOptions)?
+ * Return NOT_AN_OPTION if arg doesn't look like an option at all, or UNKNOWN_OPTION if it does, but isn't one we know.
+ */
+#define NOT_AN_OPTION  (-1)
+#define UNKNOWN_OPTION (-2)
+static int whichOption( const optionNameMap* byLongName, const int byShortName[], stringConst arg ) {
+    stringConst asLongOption  = extractLongOptionName(  arg );
+    char  asShortOption = extractShortOptionName( arg );
+    if (asLongOption != NULL) {
+        stringConst interned = intern_lookup( asLongOption );  // (if nobody interned it, it's no option of ours)
+        int* const index = (interned == NULL)  ?  NULL  :  optionNameMap_get( byLongName, interned );
+        return (index != NULL)  ?  *index  :  UNKNOWN_OPTION;
+        }
+    else if (asShortOption != '\0') {
+        int const index = byShortName[(uchar)asShortOption];
+        return (index >= 0)  ?  index  :  UNKNOWN_OPTION;
+        }
+    else {
+        return NOT_AN_OPTION;
+        }
+    }
+
+
 /* Given command-line arguments,
  * return an array with the values for ALL possible options.
  * The strings are taken from the command-line if provided, else from `options[i].default`
@@ -95,6 +124,14 @@ bool apparentOptionIsLegal( int numOptions, struct option_info options[], string
  * and options was an array with the options
  *    { {"file","f","-"}, {"name",'n',"ibarland"}, {"size",'s',NULL} }
  * then we'd return {"foo.txt", "ibarland", "27"}.
+ * If an option occurs more than once, the last one wins.
+ *
+ * Each option is matched on its own, just as findOption would (independently of the other options):
+ * so in { "--file", "--name", "x" }, file's value is "--name" -- and name's is still "x".
+ * Likewise every argument that looks like an option is checked (and warned about, if unknown),
+ * even one that's also serving as some option's value.
+ * We make one pass over argv, looking up each option-name (long ones, interned, in a hash map; short ones in a table),
+ * so the time is linear in argc+numOptions -- not their product.
  */
 stringConst* allOptions( int argc, stringConst argv[], int numOptions, struct option_info options[] ) {
     uint numOptions_u = (uint) numOptions;
@@ -102,15 +139,46 @@ stringConst* allOptions( int argc, stringConst argv[], int numOptions, struct op
     const char*  *allOpts = (const char* *) malloc( numOptions_u * sizeof(const char*) );
     // think of allOpts as array-of-stringConst.  But if declared as stringConst* we couldn't
     // assign into it (since each array-location is itself const).
+    // For each option, the index of the argument where it last matched (as findOption counts matches):
+    // an argument right after a match of the *same* option is that match's value, not a match itself.
+    long* lastMatch = (long*) malloc( MAX(numOptions_u,1u) * sizeof(long) );
+
+    optionNameMap byLongName;
+    optionNameMap_init(&byLongName);
+    optionNameMap_reserve(&byLongName, numOptions_u);
+    int byShortName[UCHAR_MAX+1];
+    for (uint c=0;  c<=UCHAR_MAX;  ++c) { byShortName[c] = -1; }
     uint i;
     for (i=0;  i<numOptions_u;  ++i) {
-        allOpts[i] = findOption( options[i], argc, argv );
+        allOpts[i] = options[i].defaultValue;
+        lastMatch[i] = -2;
+        optionNameMap_put( &byLongName, intern(options[i].longOption), (int)i );
+        if (options[i].shortOption != '\0') byShortName[(uchar)options[i].shortOption] = (int)i;
+        }
+
+    int onlyOption = -1;  // past a "--":  the one option still being matched (see below), if any.
+    for (i=0;  i < monus_u(argc_u,1u);  ++i) {
+        if (streq(argv[i],"--")) {
+            /* "--" stops option-processing -- except for an option that just took the "--" as its value
+             * (findOption, searching for that option alone, skips right over it).
+             */
+            int const prev = (i == 0)  ?  NOT_AN_OPTION  :  whichOption( &byLongName, byShortName, argv[i-1] );
+            if (prev < 0 || lastMatch[prev] != (long)i-1) break;
+            onlyOption = prev;
+            lastMatch[prev] = -2;
+            continue;
+            }
+        int const which = whichOption( &byLongName, byShortName, argv[i] );
+        if (which < 0  ||  (onlyOption >= 0 && which != onlyOption)) continue;
+        if (lastMatch[which] == (long)i-1) { lastMatch[which] = -2;  continue; }  // it's the value of the previous arg.
+        allOpts[which] = argv[i+1];
+        lastMatch[which] = (long)i;
         }
 
     // Also: make sure that everything that LOOKS like an arg is valid:
     for (i=0;  i<argc_u;  ++i) {
         if (streq(argv[i],"--")) break;
-        if (!apparentOptionIsLegal(numOptions, options, argv[i])) {
+        if (whichOption( &byLongName, byShortName, argv[i] ) == UNKNOWN_OPTION) {
             fprintf(stderr,"Warning: argument #%d, \"%s\", is not a known option.\n", i, argv[i]);
             }
          else if (i==argc_u-1 && argv[i][0]=='-' && strlen(argv[i])>1) {
@@ -118,7 +186,8 @@ stringConst* allOptions( int argc, stringConst argv[], int numOptions, struct op
             fprintf(stderr,"(Such args are not yet supported in ibarland's command-line-options, sorry.)\n" );
             }
         }
-  
+
+    free(lastMatch);
+    optionNameMap_free(&byLongName);
     return allOpts;
     }
-  
@@ -0,0 +1,815 @@
+/* Micro-benchmarks for ibarland-utils and command-line-options.
+ * Build and run with `make bench`; or run directly:
+ *    ./ibarland-utils-bench [--filter substring] [--format text|json]
+ *                           [--compare baseline.json] [--threshold percent]
+ *
+ * To check a new version of the library against an old one:
+ *    make bench-baseline      # with the old version; writes bench-baseline.json
+ *    make bench-compare       # with the new version; lists each benchmark's change, flagging any beyond 10%
+ * (--compare exits with failure if anything got slower by more than the threshold.)
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include "ibarland-utils.h"
+#include "command-line-options.h"
+
+
+#define ARRAY_SIZES  10, 1000, 100000, 10000000
+
+/* Shared, lazily-grown inputs, so that benchmarks don't time their own setup.
+ * Contents are fixed (seeded), so every run formats/parses the same data.
+ */
+static int* benchInts( long const n ) {
+    static int* arr = NULL;
+    static long sz = 0;
+    if (n > sz) {
+        free(arr);
+        arr = newArrayI_uninit( (uint)n );
+        rng_seedDefault(12345);
+        fillArrayI_rand( arr, (uint)n, -1000000, 1000000 );
+        sz = n;
+        }
+    return arr;
+    }
+
+#define MAKE_BENCH_INPUT_FUNC(suffix,typ,fromInt) \
+static typ* benchArr##suffix( long const n ) { \
+    static typ* arr = NULL; \
+    static long sz = 0; \
+    if (n > sz) { \
+        const int* ints = benchInts(n); \
+        free(arr); \
+        arr = (typ*) malloc( (size_t)n * sizeof(typ) ); \
+        for (long i=0;  i<n;  ++i) { arr[i] = fromInt(ints[i]); } \
+        sz = n; \
+        } \
+    return arr; \
+    }
+#define TO_BOOL(k)   ((k) % 2 == 0)
+#define TO_CHAR(k)   ((char)('a' + (k) % 26 + ((k) < 0 ? 26 : 0)))
+#define TO_FLOAT(k)  ((float)(k) / 7.0f)
+#define TO_LONG(k)   ((long)(k) * 1000003L)
+#define TO_DOUBLE(k) ((double)(k) / 7.0)
+MAKE_BENCH_INPUT_FUNC(B,bool,TO_BOOL)
+MAKE_BENCH_INPUT_FUNC(C,char,TO_CHAR)
+MAKE_BENCH_INPUT_FUNC(F,float,TO_FLOAT)
+MAKE_BENCH_INPUT_FUNC(Li,long,TO_LONG)
+MAKE_BENCH_INPUT_FUNC(Lf,double,TO_DOUBLE)
+#define benchArrI benchInts
+
+/* The decimal text of the first n benchInts, comma-separated. */
+static const char* benchCsv( long const n, size_t* len ) {
+    static char* csv = NULL;
+    static long sz = 0;
+    static size_t csvLen = 0;
+    if (n != sz) {
+        free(csv);
+        csv = (char*) arrI_toString( benchInts(n), (int)n, "", NULL, ",", "" );
+        csvLen = strlen(csv);
+        sz = n;
+        }
+    *len = csvLen;
+    return csv;
+    }
+
+
+
+/* ---- number formatting ---- */
+
+BENCH(intToString_into) {
+    char buf[INT_TO_STRING_MAX_LEN];
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( intToString_into( (int)(i*2654435761UL), buf, sizeof(buf) ) ); }
+    }
+
+BENCH(intToString) {
+    for (ulong i=0;  i<iters;  ++i) {
+        char* s = intToString( (int)(i*2654435761UL) );
+        DO_NOT_OPTIMIZE(s);
+        free(s);
+        }
+    }
+
+/* As intToString, but allocated from an arena, which is reset every 64 strings (as if once per request). */
+BENCH(intToString_arena) {
+    arena a;
+    arena_init(&a, 0);
+    for (ulong i=0;  i<iters;  ++i) {
+        char* s = intToString_arena( &a, (int)(i*2654435761UL) );
+        DO_NOT_OPTIMIZE(s);
+        if (i % 64 == 63) arena_reset(&a);
+        }
+    arena_free(&a);
+    }
+
+BENCH(uintToString) {
+    for (ulong i=0;  i<iters;  ++i) {
+        char* s = uintToString( (uint)(i*2654435761UL) );
+        DO_NOT_OPTIMIZE(s);
+        free(s);
+        }
+    }
+
+BENCH(longToString) {
+    for (ulong i=0;  i<iters;  ++i) {
+        char* s = longToString( (long)(i*0x9E3779B97F4A7C15UL) );
+        DO_NOT_OPTIMIZE(s);
+        free(s);
+        }
+    }
+
+BENCH(ulongToString) {
+    for (ulong i=0;  i<iters;  ++i) {
+        char* s = ulongToString( i*0x9E3779B97F4A7C15UL );
+        DO_NOT_OPTIMIZE(s);
+        free(s);
+        }
+    }
+
+BENCH(numDigits_ul) {
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( numDigits_ul( i*0x9E3779B97F4A7C15UL ) ); }
+    }
+
+BENCH_SIZED(arrI_toNumerals, ARRAY_SIZES) {
+    size_t* offsets = (size_t*) malloc( (size_t)(arg+1) * sizeof(size_t) );
+    for (ulong i=0;  i<iters;  ++i) {
+        char* s = arrI_toNumerals( benchInts(arg), (size_t)arg, offsets );
+        DO_NOT_OPTIMIZE(s);
+        free(s);
+        }
+    free(offsets);
+    }
+
+BENCH_SIZED(arrLi_toNumerals, ARRAY_SIZES) {
+    size_t* offsets = (size_t*) malloc( (size_t)(arg+1) * sizeof(size_t) );
+    for (ulong i=0;  i<iters;  ++i) {
+        char* s = arrLi_toNumerals( benchArrLi(arg), (size_t)arg, offsets );
+        DO_NOT_OPTIMIZE(s);
+        free(s);
+        }
+    free(offsets);
+    }
+
+
+
+/* ---- strings ---- */
+
+BENCH(streq) {
+    char a[] = "--some-long-option-name";
+    char b[] = "--some-long-option-namf";
+    for (ulong i=0;  i<iters;  ++i) { BENCH_CLOBBER();  DO_NOT_OPTIMIZE( streq(a,b) ); }
+    }
+
+BENCH(newStrCat) {
+    for (ulong i=0;  i<iters;  ++i) {
+        char* s = newStrCat( "some-prefix/", "and-some-suffix.txt" );
+        DO_NOT_OPTIMIZE(s);
+        free(s);
+        }
+    }
+
+/* A "request" that builds 32 temporary strings, then discards them all:  malloc/free each, vs. one arena. */
+BENCH(request_temporaries_malloc) {
+    char* temps[32];
+    for (ulong i=0;  i<iters;  ++i) {
+        for (int k=0;  k<32;  ++k) { temps[k] = newStrCat( "key-", "value" ); }
+        DO_NOT_OPTIMIZE(temps[31]);
+        for (int k=0;  k<32;  ++k) { free(temps[k]); }
+        }
+    }
+
+BENCH(request_temporaries_arena) {
+    arena a;
+    arena_init(&a, 0);
+    for (ulong i=0;  i<iters;  ++i) {
+        char* last = NULL;
+        for (int k=0;  k<32;  ++k) { last = newStrCat_arena( &a, "key-", "value" ); }
+        DO_NOT_OPTIMIZE(last);
+        arena_reset(&a);
+        }
+    arena_free(&a);
+    }
+
+BENCH(sb_appendf) {
+    strBuilder sb;
+    sb_init(&sb);
+    for (ulong i=0;  i<iters;  ++i) { sb_appendf( &sb, "%lu,", i ); }
+    DO_NOT_OPTIMIZE(sb.str);
+    sb_free(&sb);
+    }
+
+#define MAKE_TO_STRING_BENCH(suffix) \
+BENCH_SIZED(arr##suffix##_toString, ARRAY_SIZES) { \
+    for (ulong i=0;  i<iters;  ++i) { \
+        stringConst s = arr##suffix##_toString( benchArr##suffix(arg), (int)arg, NULL, NULL, NULL, NULL ); \
+        DO_NOT_OPTIMIZE(s); \
+        free((void*)s); \
+        } \
+    }
+MAKE_TO_STRING_BENCH(B)
+MAKE_TO_STRING_BENCH(C)
+MAKE_TO_STRING_BENCH(I)
+MAKE_TO_STRING_BENCH(F)
+MAKE_TO_STRING_BENCH(Li)
+MAKE_TO_STRING_BENCH(Lf)
+
+BENCH_SIZED(arrI_writeFd, ARRAY_SIZES) {
+    int const devNull = open("/dev/null", O_WRONLY);
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( arrI_writeFd( devNull, benchInts(arg), (int)arg, NULL, NULL, NULL, NULL ) ); }
+    close(devNull);
+    }
+
+BENCH_SIZED(arrLf_write, ARRAY_SIZES) {
+    FILE* devNull = fopen("/dev/null", "w");
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( arrLf_write( devNull, benchArrLf(arg), (int)arg, NULL, NULL, NULL, NULL ) ); }
+    fclose(devNull);
+    }
+
+
+
+/* ---- parsing ---- */
+
+BENCH(strtoi_or_die) {
+    stringConst numerals[] = { "0", "-17", "  2147483647 ", "-2000000000", "123456" };
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( strtoi_or_die( numerals[i%5], "bench" ) ); }
+    }
+
+BENCH(strtou_or_die) {
+    stringConst numerals[] = { "0", "17", "  4294967295 ", "3000000000", "123456" };
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( strtou_or_die( numerals[i%5], "bench" ) ); }
+    }
+
+BENCH(parse_l) {
+    stringConst numerals[] = { "0", "-17", "9223372036854775807", "-2000000000", "1234567890123" };
+    long val;
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( parse_l( numerals[i%5], NULL, &val, NULL ) );  DO_NOT_OPTIMIZE(val); }
+    }
+
+BENCH_SIZED(parseArrayI, ARRAY_SIZES) {
+    size_t len;
+    const char* csv = benchCsv(arg, &len);
+    int* out = newArrayI_uninit( (uint)arg );
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( parseArrayI( csv, len, ',', out ) );  BENCH_CLOBBER(); }
+    free(out);
+    }
+
+// The same csv, as fields of a strview (no copies, no nulls):
+BENCH_SIZED(strview_split_to_int, ARRAY_SIZES) {
+    size_t len;
+    const char* const text = benchCsv(arg, &len);
+    strview const csv = strview_of(text, len);
+    for (ulong i=0;  i<iters;  ++i) {
+        strviewSplit fields = strview_split(csv, ',');
+        strview field;
+        long sum = 0;
+        while (strview_nextField(&fields, &field)) {
+            int val = 0;
+            strview_to_int(field, &val);
+            sum += val;
+            }
+        DO_NOT_OPTIMIZE(sum);
+        BENCH_CLOBBER();
+        }
+    }
+
+// Scanning all of the csv for a char that isn't there:
+BENCH_SIZED(strview_findChar, ARRAY_SIZES) {
+    size_t len;
+    const char* const text = benchCsv(arg, &len);
+    strview const csv = strview_of(text, len);
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( strview_findChar(csv, '\n') );  BENCH_CLOBBER(); }
+    }
+// vs. a byte at a time:
+BENCH_SIZED(findChar_loop, ARRAY_SIZES) {
+    size_t len;
+    const char* csv = benchCsv(arg, &len);
+    for (ulong i=0;  i<iters;  ++i) {
+        size_t j = 0;
+        while (j < len && csv[j] != '\n') ++j;
+        DO_NOT_OPTIMIZE(j);
+        BENCH_CLOBBER();
+        }
+    }
+
+
+
+/* Temp files for the file-loading benchmarks (removed at exit). */
+static char benchCsvPath[] = "/tmp/ibarland-utils-bench-XXXXXX";
+static char benchBinPath[] = "/tmp/ibarland-utils-bench-XXXXXX";
+static bool benchCsvPathMade = false, benchBinPathMade = false;
+static const char* benchTempFile( char* path, bool* made ) {
+    if (!*made) {
+        int const fd = mkstemp(path);
+        assert(fd >= 0);
+        close(fd);
+        *made = true;
+        }
+    return path;
+    }
+__attribute__((destructor)) static void removeBenchTempFiles() {
+    if (benchCsvPathMade) unlink(benchCsvPath);
+    if (benchBinPathMade) unlink(benchBinPath);
+    }
+
+/* The path of a temp file holding benchCsv(n). */
+static const char* benchCsvFile( long const n ) {
+    static long sz = -1;
+    const char* path = benchTempFile(benchCsvPath, &benchCsvPathMade);
+    if (n != sz) {
+        size_t len;
+        const char* csv = benchCsv(n, &len);
+        FILE* f = fopen(path, "w");
+        fwrite(csv, 1, len, f);
+        fclose(f);
+        sz = n;
+        }
+    return path;
+    }
+
+/* The path of a temp file holding benchArrLf(n), saved by saveArrayLf. */
+static const char* benchBinFile( long const n ) {
+    static long sz = -1;
+    const char* path = benchTempFile(benchBinPath, &benchBinPathMade);
+    if (n != sz) {
+        saveArrayLf( path, benchArrLf(n), (ulong)n );
+        sz = n;
+        }
+    return path;
+    }
+
+BENCH_SIZED(fscanf_ints, ARRAY_SIZES) {
+    const char* path = benchCsvFile(arg);
+    int* out = newArrayI_uninit( (uint)arg );
+    for (ulong i=0;  i<iters;  ++i) {
+        FILE* f = fopen(path, "r");
+        long n = 0;
+        while (n < arg && fscanf(f, "%d,", &out[n]) == 1) ++n;
+        fclose(f);
+        DO_NOT_OPTIMIZE(n);
+        BENCH_CLOBBER();
+        }
+    free(out);
+    }
+
+BENCH_SIZED(newArrayI_fromFile, ARRAY_SIZES) {
+    const char* path = benchCsvFile(arg);
+    for (ulong i=0;  i<iters;  ++i) {
+        ulong n;
+        int* arr = newArrayI_fromFile(path, &n);
+        DO_NOT_OPTIMIZE(arr);
+        free(arr);
+        }
+    }
+
+BENCH_SIZED(newArrayLf_fromFile, ARRAY_SIZES) {
+    const char* path = benchCsvFile(arg);
+    for (ulong i=0;  i<iters;  ++i) {
+        ulong n;
+        double* arr = newArrayLf_fromFile(path, &n);
+        DO_NOT_OPTIMIZE(arr);
+        free(arr);
+        }
+    }
+
+// Checkpointing an array in binary, vs. as text (arrLf_write) -- and reloading it, vs. parsing (newArrayLf_fromFile):
+BENCH_SIZED(saveArrayLf, ARRAY_SIZES) {
+    const char* path = benchTempFile(benchBinPath, &benchBinPathMade);
+    const double* xs = benchArrLf(arg);
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( saveArrayLf(path, xs, (ulong)arg) ); }
+    }
+
+BENCH_SIZED(mapArrayLf_sum, ARRAY_SIZES) {
+    const char* path = benchBinFile(arg);
+    for (ulong i=0;  i<iters;  ++i) {
+        ulong n;
+        const double* xs = mapArrayLf(path, &n);
+        double sum = 0;
+        for (ulong k=0;  k<n;  ++k) { sum += xs[k]; }
+        DO_NOT_OPTIMIZE(sum);
+        unmapArray(xs);
+        }
+    }
+
+
+
+/* ---- arithmetic ---- */
+
+BENCH(modPos) {
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( modPos( (int)i - 1000, 7 ) ); }
+    }
+
+BENCH(lmodPos) {
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( lmodPos( (long)i - 1000, 7 ) ); }
+    }
+
+BENCH(modPos_by) {
+    moddiv_t div;
+    moddiv_init( &div, 7 );
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( modPos_by( (int)i - 1000, &div ) ); }
+    }
+
+BENCH_SIZED(modPosArr, ARRAY_SIZES) {
+    const int* ns = benchInts(arg);
+    int* out = newArrayI_uninit( (uint)arg );
+    for (ulong i=0;  i<iters;  ++i) { modPosArr( ns, (ulong)arg, 1000 + (int)(i%2), out );  BENCH_CLOBBER(); }
+    free(out);
+    }
+
+BENCH(sgn) {
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( sgn( (long)i - 1000 ) ); }
+    }
+
+BENCH(monus) {
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( monus( (int)i, 1000 ) ); }
+    }
+
+BENCH(degToRad) {
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( degToRad( (double)i ) ); }
+    }
+
+BENCH(radToDeg) {
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( radToDeg( (double)i ) ); }
+    }
+
+BENCH(angleNormalize) {
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( angleNormalize( (double)i - 1000.5 ) ); }
+    }
+
+BENCH_SIZED(degToRadArr, ARRAY_SIZES) {
+    const double* thetas = benchArrLf(arg);
+    double* out = newArrayLf_uninit( (uint)arg );
+    for (ulong i=0;  i<iters;  ++i) { degToRadArr( thetas, (ulong)arg, out );  BENCH_CLOBBER(); }
+    free(out);
+    }
+
+BENCH_SIZED(angleNormalizeArr, ARRAY_SIZES) {
+    const double* thetas = benchArrLf(arg);
+    double* out = newArrayLf_uninit( (uint)arg );
+    for (ulong i=0;  i<iters;  ++i) { angleNormalizeArr( thetas, (ulong)arg, out );  BENCH_CLOBBER(); }
+    free(out);
+    }
+
+BENCH_SIZED(angleNormalizeSignedArrF, ARRAY_SIZES) {
+    const float* thetas = benchArrF(arg);
+    float* out = newArrayF_uninit( (uint)arg );
+    for (ulong i=0;  i<iters;  ++i) { angleNormalizeSignedArrF( thetas, (ulong)arg, out );  BENCH_CLOBBER(); }
+    free(out);
+    }
+
+/* benchArrF's values run past 8192, where the float trig functions hand off to libm;  keep these in range. */
+static const float* benchAnglesF( long const n ) {
+    static float* arr = NULL;
+    static long sz = 0;
+    if (n > sz) {
+        const float* fs = benchArrF(n);
+        free(arr);
+        arr = newArrayF_uninit( (uint)n );
+        for (long i=0;  i<n;  ++i) { arr[i] = fs[i] / 20.0f; }
+        sz = n;
+        }
+    return arr;
+    }
+
+/* (atan2 takes its ys from the second half of the inputs.) */
+#define MAKE_TRIG_BENCH(name, typ, newArr, inputs, call) \
+BENCH_SIZED(name, ARRAY_SIZES) { \
+    const typ* xs = inputs(2*arg); \
+    typ* out = newArr( (uint)arg ); \
+    ulong const sz = (ulong)arg; \
+    for (ulong i=0;  i<iters;  ++i) { call;  BENCH_CLOBBER(); } \
+    free(out); \
+    }
+MAKE_TRIG_BENCH(sin_libm,       double, newArrayLf_uninit, benchArrLf, for (ulong j=0; j<sz; ++j) out[j] = sin(xs[j]) )
+MAKE_TRIG_BENCH(sinArr_fast,    double, newArrayLf_uninit, benchArrLf, sinArr( xs, sz, out, TRIG_FAST ) )
+MAKE_TRIG_BENCH(sinArr_medium,  double, newArrayLf_uninit, benchArrLf, sinArr( xs, sz, out, TRIG_MEDIUM ) )
+MAKE_TRIG_BENCH(sinArr_full,    double, newArrayLf_uninit, benchArrLf, sinArr( xs, sz, out, TRIG_FULL ) )
+MAKE_TRIG_BENCH(cosArr_full,    double, newArrayLf_uninit, benchArrLf, cosArr( xs, sz, out, TRIG_FULL ) )
+MAKE_TRIG_BENCH(atan2_libm,     double, newArrayLf_uninit, benchArrLf, for (ulong j=0; j<sz; ++j) out[j] = atan2(xs[sz+j], xs[j]) )
+MAKE_TRIG_BENCH(atan2Arr_fast,  double, newArrayLf_uninit, benchArrLf, atan2Arr( xs+sz, xs, sz, out, TRIG_FAST ) )
+MAKE_TRIG_BENCH(atan2Arr_full,  double, newArrayLf_uninit, benchArrLf, atan2Arr( xs+sz, xs, sz, out, TRIG_FULL ) )
+MAKE_TRIG_BENCH(sinf_libm,      float,  newArrayF_uninit,  benchAnglesF, for (ulong j=0; j<sz; ++j) out[j] = sinf(xs[j]) )
+MAKE_TRIG_BENCH(sinArrF_fast,   float,  newArrayF_uninit,  benchAnglesF, sinArrF( xs, sz, out, TRIG_FAST ) )
+MAKE_TRIG_BENCH(sinArrF_full,   float,  newArrayF_uninit,  benchAnglesF, sinArrF( xs, sz, out, TRIG_FULL ) )
+MAKE_TRIG_BENCH(atan2f_libm,    float,  newArrayF_uninit,  benchAnglesF, for (ulong j=0; j<sz; ++j) out[j] = atan2f(xs[sz+j], xs[j]) )
+MAKE_TRIG_BENCH(atan2ArrF_full, float,  newArrayF_uninit,  benchAnglesF, atan2ArrF( xs+sz, xs, sz, out, TRIG_FULL ) )
+
+BENCH(approxEquals) {
+    double const vals[] = { 2.0, 2.000000001, -1e-10, INFINITY, NAN, 2.0e128, 1e10 };
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( approxEquals( vals[i%7], vals[(i+1)%7] ) ); }
+    }
+
+BENCH_SIZED(approxEqualsArrD, ARRAY_SIZES) {
+    const double* xs = benchArrLf(arg);
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( approxEqualsArrD( xs, xs, (ulong)arg, 0.00001, 1e-9 ).count ); }
+    }
+
+BENCH_SIZED(approxEqualsArrF, ARRAY_SIZES) {
+    const float* xs = benchArrF(arg);
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( approxEqualsArrF( xs, xs, (ulong)arg, 0.00001, 1e-9 ).count ); }
+    }
+
+BENCH(ulpDistance) {
+    double const vals[] = { 2.0, 2.000000001, -1e-10, INFINITY, NAN, 2.0e128, 1e10 };
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( ulpDistance( vals[i%7], vals[(i+1)%7] ) ); }
+    }
+
+BENCH_SIZED(ulpDistanceArr_histogram, ARRAY_SIZES) {
+    const double* xs = benchArrLf(arg);
+    ulpHistogram hist;
+    ulpHistogram_init(&hist);
+    for (ulong i=0;  i<iters;  ++i) { ulpDistanceArr( xs, xs + (arg > 1), (ulong)(arg - (arg > 1)), NULL, &hist ); }
+    DO_NOT_OPTIMIZE(hist.total);
+    }
+
+BENCH(swap_i) {
+    int a = 1,  b = 2;
+    for (ulong i=0;  i<iters;  ++i) { swap_i(&a, &b);  BENCH_CLOBBER(); }
+    DO_NOT_OPTIMIZE(a);
+    }
+
+
+
+/* ---- arrays ---- */
+
+BENCH_SIZED(newArrayI, ARRAY_SIZES) {
+    for (ulong i=0;  i<iters;  ++i) {
+        int* arr = newArrayI( (uint)arg, 7 );
+        DO_NOT_OPTIMIZE(arr);
+        free(arr);
+        }
+    }
+
+BENCH_SIZED(fillArrayI, ARRAY_SIZES) {
+    int* arr = newArrayI_uninit( (uint)arg );
+    for (ulong i=0;  i<iters;  ++i) { fillArrayI( arr, (uint)arg, (int)i );  BENCH_CLOBBER(); }
+    free(arr);
+    }
+
+BENCH(rng_next) {
+    rngState rng;
+    rng_seed(&rng, 1);
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( rng_next(&rng) ); }
+    }
+
+BENCH(rng_rangeI) {
+    rngState rng;
+    rng_seed(&rng, 1);
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( rng_rangeI(&rng, -1000, 1000) ); }
+    }
+
+BENCH_SIZED(fillArrayI_rand_par, ARRAY_SIZES) {
+    int* arr = newArrayI_uninit( (uint)arg );
+    for (ulong i=0;  i<iters;  ++i) { fillArrayI_rand_par( arr, (ulong)arg, -1000, 1000, i, 0 );  BENCH_CLOBBER(); }
+    free(arr);
+    }
+
+BENCH_SIZED(fillArrayLf, ARRAY_SIZES) {
+    double* arr = newArrayLf_aligned( (uint)arg, 0 );
+    for (ulong i=0;  i<iters;  ++i) { fillArrayLf( arr, (uint)arg, (double)i );  BENCH_CLOBBER(); }
+    free(arr);
+    }
+
+BENCH_SIZED(fillArrayLf_rand, ARRAY_SIZES) {
+    double* arr = newArrayLf_uninit( (uint)arg );
+    for (ulong i=0;  i<iters;  ++i) { fillArrayLf_rand( arr, (uint)arg, -1.0, 1.0 );  BENCH_CLOBBER(); }
+    free(arr);
+    }
+
+BENCH_SIZED(fillArrayI_rand, ARRAY_SIZES) {
+    int* arr = newArrayI_uninit( (uint)arg );
+    for (ulong i=0;  i<iters;  ++i) { fillArrayI_rand( arr, (uint)arg, -1000, 1000 );  BENCH_CLOBBER(); }
+    free(arr);
+    }
+
+/* Building (then freeing) a linked list of `arg` nodes:  ALLOC/free vs. a pool. */
+typedef struct benchNode { long val;  struct benchNode* next; } benchNode;
+POOL_DEFINE(benchNode)
+
+BENCH_SIZED(list_malloc, 10, 1000, 100000) {
+    for (ulong i=0;  i<iters;  ++i) {
+        benchNode* list = NULL;
+        for (long k=0;  k<arg;  ++k) { benchNode* n = ALLOC(benchNode);  n->val = k;  n->next = list;  list = n; }
+        DO_NOT_OPTIMIZE(list);
+        while (list != NULL) { benchNode* next = list->next;  free(list);  list = next; }
+        }
+    }
+
+BENCH_SIZED(list_pool, 10, 1000, 100000) {
+    for (ulong i=0;  i<iters;  ++i) {
+        benchNode* list = NULL;
+        for (long k=0;  k<arg;  ++k) { benchNode* n = POOL_ALLOC(benchNode);  n->val = k;  n->next = list;  list = n; }
+        DO_NOT_OPTIMIZE(list);
+        while (list != NULL) { benchNode* next = list->next;  POOL_FREE(benchNode, list);  list = next; }
+        }
+    }
+
+/* Building a vector one push at a time, from empty (including its mallocs and frees). */
+BENCH_SIZED(vecI_push, ARRAY_SIZES) {
+    for (ulong i=0;  i<iters;  ++i) {
+        vecI v;
+        vecI_init(&v);
+        for (long k=0;  k<arg;  ++k) { vecI_push(&v, (int)k); }
+        DO_NOT_OPTIMIZE(v.data[v.len-1]);
+        vecI_free(&v);
+        }
+    }
+
+BENCH(vecI_push_small) {
+    for (ulong i=0;  i<iters;  ++i) {
+        vecI v;
+        vecI_init(&v);
+        for (int k=0;  k<4;  ++k) { vecI_push(&v, k); }  // fits in the small-buffer
+        DO_NOT_OPTIMIZE(v.data[3]);
+        vecI_free(&v);
+        }
+    }
+
+
+
+/* ---- timing, processes ---- */
+
+BENCH(time_usec) {
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( time_usec() ); }
+    }
+
+BENCH(time_nsec) {
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( time_nsec() ); }
+    }
+
+BENCH(cycles_now) {
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( cycles_now() ); }
+    }
+
+BENCH(forkAndExec) {
+    for (ulong i=0;  i<iters;  ++i) {
+        pid_t const child = forkAndExec("/bin/true");
+        waitpid(child, NULL, 0);
+        }
+    }
+
+BENCH(spawnProcess) {
+    for (ulong i=0;  i<iters;  ++i) {
+        pid_t child;
+        if (spawnProcess(&child, "/bin/true", NULL, NULL, NULL) == 0) waitpid(child, NULL, 0);
+        }
+    }
+
+/* The same, from a parent with (another) 512MB resident:  fork copies page tables for all of it; spawn doesn't. */
+static void touchBigRss() {
+    static char* big = NULL;
+    size_t const bigBytes = (size_t)512 << 20;
+    if (big == NULL) {
+        big = (char*) malloc(bigBytes);
+        memset(big, 1, bigBytes);
+        }
+    DO_NOT_OPTIMIZE(big);
+    }
+
+BENCH(forkAndExec_bigRss) {
+    touchBigRss();
+    for (ulong i=0;  i<iters;  ++i) {
+        pid_t const child = forkAndExec("/bin/true");
+        waitpid(child, NULL, 0);
+        }
+    }
+
+BENCH(spawnProcess_bigRss) {
+    touchBigRss();
+    for (ulong i=0;  i<iters;  ++i) {
+        pid_t child;
+        if (spawnProcess(&child, "/bin/true", NULL, NULL, NULL) == 0) waitpid(child, NULL, 0);
+        }
+    }
+
+
+
+/* ---- command-line-options ---- */
+
+struct option_info benchedOptions[] =
+  {  { "file",  'f',  "foo.txt", "" }
+    ,{ "name",  'n',  "ibarland", "" }
+    ,{ "size",  's',  "98", "" }
+    ,{ "stuff", '\0', NULL, "" }
+    ,{ "otherStuff", 'o', "blarg", "" }
+    };
+
+/* An argv of n entries, cycling through the options' long and short forms (each followed by a value). */
+static stringConst* benchArgv( long const n ) {
+    static stringConst forms[] = { "--file", "-n", "--size", "--stuff", "-o", "--name", "-f" };
+    const char* *argv = (const char* *) malloc( (size_t)n * sizeof(const char*) );
+    argv[0] = "prog";
+    for (long i=1;  i<n;  ++i) { argv[i] = (i%2 == 1)  ?  forms[(size_t)(i/2) % SIZEOF_ARRAY(forms)]  :  "value"; }
+    return argv;
+    }
+
+/* Comparing identifiers:  strcmp vs. interned pointers (the strings differ only at the end). */
+BENCH(streq_identifiers) {
+    static char a[] = "some_longish_identifier_1";
+    static char b[] = "some_longish_identifier_2";
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( streq(a, b) );  BENCH_CLOBBER(); }
+    }
+
+BENCH(streq_interned_identifiers) {
+    stringConst a = intern("some_longish_identifier_1");
+    stringConst b = intern("some_longish_identifier_2");
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( streq_interned(a, b) );  BENCH_CLOBBER(); }
+    }
+
+/* Finding the canonical copy of an already-interned string (the lock-free path). */
+BENCH(intern_existing) {
+    intern("some_longish_identifier_1");
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( intern("some_longish_identifier_1") ); }
+    }
+
+BENCH(strHash_short) {
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( strHash("otherStuff") ); }
+    }
+
+DECLARE_HASHMAP(benchMap, ulong, long)
+#define BENCH_SAME(a,b) ((a)==(b))
+DEFINE_HASHMAP(benchMap, ulong, long, ulongHash, BENCH_SAME)
+
+/* A map of keys 0,3,6,...,3(n-1);  built once per size (so that benchmarks don't time their own setup). */
+static benchMap* benchMapOf( long const n ) {
+    static benchMap m;
+    static long sz = -1;
+    if (n != sz) {
+        if (sz != -1) benchMap_free(&m);
+        benchMap_init(&m);
+        for (long k=0;  k<n;  ++k) { benchMap_put(&m, (ulong)k*3, k); }
+        sz = n;
+        }
+    return &m;
+    }
+
+/* Look up keys in a map of `arg` entries (a third of them present). */
+BENCH_SIZED(hashmap_get, 10, 1000, 100000) {
+    benchMap* const m = benchMapOf(arg);
+    for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( benchMap_get(m, (i*7) % (ulong)(3*arg)) ); }
+    }
+
+/* Insert a new key and remove an old one (so the size holds steady). */
+BENCH_SIZED(hashmap_put_remove, 10, 1000, 100000) {
+    benchMap* const m = benchMapOf(arg);
+    for (ulong i=0;  i<iters;  ++i) {
+        ulong const k = 3*(ulong)arg + 3*(i % (ulong)arg) + 1;
+        benchMap_put(m, k, (long)i);
+        benchMap_remove(m, k);
+        }
+    }
+
+BENCH_SIZED(allOptions, 11, 1001, 5001) {
+    stringConst* argv = benchArgv(arg);
+    for (ulong i=0;  i<iters;  ++i) {
+        stringConst* settings = allOptions( (int)arg, argv, SIZEOF_ARRAY(benchedOptions), benchedOptions );
+        DO_NOT_OPTIMIZE(settings);
+        free((void*)settings);
+        }
+    free((void*)argv);
+    }
+
+
+
+struct option_info options[] =
+  {  { "filter",    'f',  NULL,   "only run benchmarks whose name contains this" }
+    ,{ "format",    '\0', "text", "text or json" }
+    ,{ "compare",   'c',  NULL,   "a baseline (from --format json) to compare against" }
+    ,{ "threshold", 't',  "10",   "with --compare: the % change to flag" }
+    };
+#define NUM_OPTIONS SIZEOF_ARRAY(options)
+
+int main( int argc, stringConst argv[] ) {
+    stringConst* settings = allOptions( argc, argv, NUM_OPTIONS, options );
+    stringConst filter = settings[0];
+    stringConst format = settings[1];
+    stringConst baselinePath = settings[2];
+    int const threshold = strtoi_or_die( settings[3], "threshold" );
+    if (strdiff(format,"text") && strdiff(format,"json")) {
+        fprintf(stderr, "--format must be text or json; got \"%s\".\n", format);
+        return EXIT_FAILURE;
+        }
+
+    if (baselinePath == NULL) {
+        int const numRun = runAllBenches( filter, streq(format,"json"), stdout );
+        if (numRun == 0) fprintf(stderr, "No benchmarks matched \"%s\".\n", filter);
+        return EXIT_SUCCESS;
+        }
+
+    FILE* baselineFile = fopen(baselinePath, "r");
+    if (baselineFile == NULL) { perror(baselinePath);  return EXIT_FAILURE; }
+    int nBase;
+    benchResult* baseline = readBenchResults_json( baselineFile, &nBase );
+    fclose(baselineFile);
+    int nCur;
+    benchResult* current = runBenches( filter, stderr, &nCur );
+    int const regressions = printBenchComparison( stdout, baseline, nBase, current, nCur, threshold );
+    printf("%d of %d benchmarks got slower by more than %d%%.\n", regressions, nCur, threshold);
+    freeBenchResults(current, nCur);
+    freeBenchResults(baseline, nBase);
+    return (regressions == 0)  ?  EXIT_SUCCESS  :  EXIT_FAILURE;
+    }
@@ -3,8 +3,112 @@
 #include <limits.h>  // for INT_MAX etc
 #include <float.h>  // for DBL_MAX etc
 #include <math.h>  // for M_PI
+#include <errno.h>  // for EINVAL, ERANGE
+#include <string.h>  // for strlen
+#include <stdint.h>  // for uintptr_t
+#include <assert.h>
+#include <unistd.h>  // for unlink
+#include <sys/wait.h>  // for waitpid
 #include "ibarland-utils.h"
 
+static void benchSumTo( ulong const iters, long const arg ) {
+    for (ulong i=0;  i<iters;  ++i) {
+        long sum = 0;
+        for (long k=0;  k<arg;  ++k) { sum += k;  BENCH_CLOBBER(); }
+        DO_NOT_OPTIMIZE(sum);
+        }
+    }
+
+/* Several cases at once, all bumping the shared counts. */
+#define PARALLEL_COUNT_TESTS 1000
+#define MAKE_PARALLEL_COUNT_CASE(name) \
+TEST_CASE(name) { \
+    for (int k=0;  k<PARALLEL_COUNT_TESTS;  ++k) { testInt( modPos(k,7), k%7 ); } \
+    }
+MAKE_PARALLEL_COUNT_CASE(parallelCount_a)
+MAKE_PARALLEL_COUNT_CASE(parallelCount_b)
+MAKE_PARALLEL_COUNT_CASE(parallelCount_c)
+MAKE_PARALLEL_COUNT_CASE(parallelCount_d)
+
+/* A vector of some non-library type. */
+typedef struct { double x, y, z; } point3;  // (bigger than VEC_SMALL_BYTES)
+DECLARE_VEC(Pt, point3)
+DEFINE_VEC(Pt, point3)
+
+/* Hash maps, keyed by strings and by ints. */
+DECLARE_HASHMAP(strIntMap, const char*, int)
+DEFINE_HASHMAP(strIntMap, const char*, int, strHash, streq)
+#define SAME_ULONG(a,b)  ((a)==(b))
+DECLARE_HASHMAP(ulongMap, ulong, long)
+DEFINE_HASHMAP(ulongMap, ulong, long, ulongHash, SAME_ULONG)
+#define COLLIDING_HASH(k)  ((k) % 4)   // terrible on purpose:  long runs of collisions
+DECLARE_HASHMAP(collideMap, ulong, long)
+DEFINE_HASHMAP(collideMap, ulong, long, COLLIDING_HASH, SAME_ULONG)
+
+/* Several threads interning the same strings (in a shuffled order) must all get the same canonical copies. */
+#define INTERN_TEST_STRINGS 3000
+static internTable* sharedInterns;
+static void* internTestWorker( void* arg ) {
+    const char* *results = (const char* *) arg;
+    char buf[32];
+    for (int k=0;  k<INTERN_TEST_STRINGS;  ++k) {
+        int const which = (k * 7 + (int)((uintptr_t)results % 13)) % INTERN_TEST_STRINGS;  // (7 is coprime to the count)
+        sprintf(buf, "identifier_%d", which);
+        results[which] = internTable_intern(sharedInterns, buf);
+        }
+    return NULL;
+    }
+
+/* (Over)write the file at `path` to hold exactly `contents`. */
+static void writeTestFile( stringConst path, stringConst contents ) {
+    FILE* f = fopen(path, "w");
+    assert(f != NULL);
+    fputs(contents, f);
+    fclose(f);
+    }
+
+/* Read (up to cap-1 chars of) the file at `path` into buf, null-terminated. */
+static const char* readTestFile( stringConst path, char* buf, size_t cap ) {
+    FILE* f = fopen(path, "r");
+    assert(f != NULL);
+    size_t const n = fread(buf, 1, cap-1, f);
+    buf[n] = '\0';
+    fclose(f);
+    return buf;
+    }
+
+/* Wait for the child, and return its exit status (or -1 if it didn't exit normally). */
+static int waitForExit( pid_t const child ) {
+    int status;
+    if (waitpid(child, &status, 0) != child || !WIFEXITED(status)) return -1;
+    return WEXITSTATUS(status);
+    }
+
+/* A pool, shared by several threads that each build (and check, and free) a linked list. */
+typedef struct listNode { long val;  struct listNode* next; } listNode;
+POOL_DEFINE(listNode)
+#define POOL_TEST_NODES 20000
+static void* poolTestWorker( void* arg ) {
+    long const id = (long)(intptr_t)arg;
+    bool ok = true;
+    for (int round=0;  round<3;  ++round) {
+        listNode* list = NULL;
+        for (long k=0;  k<POOL_TEST_NODES;  ++k) {
+            listNode* const n = POOL_ALLOC(listNode);
+            n->val = id*POOL_TEST_NODES + k;
+            n->next = list;
+            list = n;
+            }
+        for (long k=POOL_TEST_NODES-1;  k>=0;  --k) {  // (no other thread was handed any of our nodes)
+            ok = ok && list->val == id*POOL_TEST_NODES + k;
+            listNode* const next = list->next;
+            POOL_FREE(listNode, list);
+            list = next;
+            }
+        }
+    return ok ? arg : NULL;
+    }
+
 int main() {
 
     testStr("abc","abc");
@@ -55,6 +159,46 @@ int main() {
     //   it takes the positive and applies unary-minus, which may trigger implicit conversions (!) 
     stringOnHeap = longToString( LONG_MAX );   testStr(stringOnHeap,  "9223372036854775807" ); free(stringOnHeap);
     stringOnHeap = longToString( LONG_MIN );   testStr(stringOnHeap, "-9223372036854775808" ); free(stringOnHeap);
+    stringOnHeap = ulongToString( 0UL );       testStr(stringOnHeap, "0" );           free(stringOnHeap);
+    stringOnHeap = ulongToString( ULONG_MAX ); testStr(stringOnHeap, "18446744073709551615" ); free(stringOnHeap);
+
+    char numeral[INT_TO_STRING_MAX_LEN];
+    testUInt( (uint)intToString_into( -307, numeral, sizeof(numeral) ), 4u );     testStr( numeral, "-307" );
+    testUInt( (uint)intToString_into( 12345, numeral, 5 ), 5u );                 testStr( numeral, "-307" );  // didn't fit; untouched.
+    testUInt( (uint)intToString_into( 12345, NULL, 0 ), 5u );
+    testUInt( (uint)longToString_into( LONG_MIN, numeral, sizeof(numeral) ), 20u );  testStr( numeral, "-9223372036854775808" );
+    testUInt( (uint)ulongToString_into( ULONG_MAX, numeral, sizeof(numeral) ), 20u ); testStr( numeral, "18446744073709551615" );
+    testUInt( numDigits_u(0), 1 );
+    testUInt( numDigits_u(9), 1 );
+    testUInt( numDigits_u(10), 2 );
+    testUInt( numDigits_u(UINT_MAX), 10 );
+    testUInt( numDigits_ul(999999999999UL), 12 );
+    testUInt( numDigits_ul(ULONG_MAX), 20 );
+    // Compare against sprintf, near every power of 10:
+    bool allMatch = true;
+    char viaSprintf[INT_TO_STRING_MAX_LEN];
+    for (ulong p=1;  p <= 1000000000000000000UL;  p *= 10) {
+        for (long d = -1;  d <= 1;  ++d) {
+            long const val = (long)p + d;
+            longToString_into( val, numeral, sizeof(numeral) );  sprintf( viaSprintf, "%ld", val );
+            allMatch = allMatch && streq(numeral, viaSprintf);
+            longToString_into( -val, numeral, sizeof(numeral) );  sprintf( viaSprintf, "%ld", -val );
+            allMatch = allMatch && streq(numeral, viaSprintf);
+            intToString_into( (int)val, numeral, sizeof(numeral) );  sprintf( viaSprintf, "%d", (int)val );
+            allMatch = allMatch && streq(numeral, viaSprintf);
+            }
+        }
+    testBool( allMatch, true );
+
+    long numsToFormat[] = { 0, -1, 42, LONG_MIN };
+    size_t offsets[SIZEOF_ARRAY(numsToFormat)+1];
+    stringOnHeap = arrLi_toNumerals( numsToFormat, SIZEOF_ARRAY(numsToFormat), offsets );
+    testStr( stringOnHeap+offsets[0], "0" );
+    testStr( stringOnHeap+offsets[1], "-1" );
+    testStr( stringOnHeap+offsets[2], "42" );
+    testStr( stringOnHeap+offsets[3], "-9223372036854775808" );
+    testUInt( (uint)offsets[4], 2+3+3+21 );
+    free(stringOnHeap);
     
     
     stringOnHeap = newStrCat("","");           testStr(stringOnHeap, "" );               free(stringOnHeap);
@@ -62,9 +206,32 @@ int main() {
     stringOnHeap = newStrCat("","def");        testStr(stringOnHeap, "def" );            free(stringOnHeap);
     stringOnHeap = newStrCat("abc","def");     testStr(stringOnHeap, "abcdef" );         free(stringOnHeap);
 
+    strBuilder sb;
+    sb_init(&sb);
+    stringOnHeap = sb_finish(&sb);             testStr(stringOnHeap, "" );               free(stringOnHeap);
+    sb_append(&sb, "abc");
+    sb_append(&sb, "");
+    sb_appendn(&sb, "defghi", 3);
+    sb_appendf(&sb, "<%i,%s>", -17, "xyz");
+    testUInt( (uint)sb.len, 15u );
+    stringOnHeap = sb_finish(&sb);             testStr(stringOnHeap, "abcdef<-17,xyz>" ); free(stringOnHeap);
+    testStr( sb.str, NULL );  // finishing resets the builder.
+    for (int k=0;  k<1000;  ++k) { sb_appendf(&sb, "%03i", k); }  // make it grow, many times.
+    testUInt( (uint)sb.len, 3000u );
+    testStr( sb.str + 2994, "998999" );
+    sb_free(&sb);
+
     
     testBool( time_usec() > 1451606400L*1000000L, true );  // > 2016 AD
     testBool( time_usec() < 3786912000L*1000000L, true );  // < 2090 AD
+    ulong const nsecBefore = time_nsec();
+    ulong const cyclesBefore = cycles_now();
+    testBool( calibrateCycles() > 0.0, true );
+    ulong const cyclesElapsed = cycles_now_ordered() - cyclesBefore;
+    ulong const nsecElapsed = time_nsec() - nsecBefore;
+    testBool( nsecElapsed >= 5000000UL, true );  // calibrating takes 5ms.
+    testBool( approxEqualsRel( (double)cyclesToNsec(cyclesElapsed), (double)nsecElapsed, 0.05, 0.0 ), true );
+    testBool( labs( (long)time_nsec_coarse() - (long)time_nsec() ) < 100000000L, true );  // coarse, but within 0.1s.
     printTestMsg("\nCurrent time in ms is %ld. (2016=%ld, 2017=%ld).\n", time_usec(), 1451606400L*1000000L, 1483228800L*1000000L );
     
     testInt( strtoi_or_die(  "0", "test-pass-a"),   0 );
@@ -76,13 +243,22 @@ int main() {
     testInt( strtoi_or_die("-2000000000", "test-pass-f"), -2000000000 );
     testInt( strtoi_or_die(intToString(INT_MAX), "test-pass-g"), INT_MAX);
     testInt( strtoi_or_die(intToString(INT_MIN), "test-pass-h"), INT_MIN);
+    testInt( strtoi_or_die( "0x10", "test-pass-i"), 16 );  // hex and octal, as strtol with base 0
+    testInt( strtoi_or_die("-0XfF", "test-pass-j"), -255 );
+    testInt( strtoi_or_die(  "010", "test-pass-k"), 8 );
+    testInt( strtoi_or_die(  "-07", "test-pass-l"), -7 );
+    testInt( strtoi_or_die( "0x7fffffff", "test-pass-m"), INT_MAX );
+    testInt( strtoi_or_die("-0x80000000", "test-pass-n"), INT_MIN );
     
     //testInt( strtoi_or_die( "", "oops!a" ), 0 );  // will exit program
     //testInt( strtoi_or_die( "hi", "oops!b" ), 0 );  // will exit program
-    testInt( strtoi_or_die( "3hi", "oops!c" ), 3 );  // HEY -- this passes!  TODO: use the 2nd arg to strtol
-    testInt( strtoi_or_die( "3.9", "oops!c2" ), 3 );  // HEY -- this passes!  TODO: use the 2nd arg to strtol
+    //testInt( strtoi_or_die( "3hi", "oops!c" ), 0 );  // will exit program
+    //testInt( strtoi_or_die( "3.9", "oops!c2" ), 0 );  // will exit program
     //testInt( strtoi_or_die( "3000000000", "oops!d" ), 0 );  // will exit program
     //testInt( strtoi_or_die( "-3000000000", "oops!e" ), 0 );  // will exit program
+    //testInt( strtoi_or_die( "09", "oops!f" ), 0 );  // will exit program
+    //testInt( strtoi_or_die( "0x", "oops!g" ), 0 );  // will exit program
+    //testInt( strtoi_or_die( "0x80000000", "oops!h" ), 0 );  // will exit program
     
     testUInt( strtou_or_die(  "0", "test-pass-a"),   0 );
     testUInt( strtou_or_die( "23", "test-pass-b"),  23 );
@@ -91,14 +267,150 @@ int main() {
     testUInt( strtou_or_die( "2000000000", "test-pass-e"), +2000000000 );
     testUInt( strtou_or_die( "3000000000", "test-pass-f" ), +3000000000 );
     testUInt( strtou_or_die(uintToString(UINT_MAX), "test-pass-g"), UINT_MAX);
+    testUInt( strtou_or_die( "0x10", "test-pass-h"), 16 );
+    testUInt( strtou_or_die( "0xFFFFFFFF", "test-pass-i"), UINT_MAX );
+    testUInt( strtou_or_die(  "010", "test-pass-j"), 8 );
+    testUInt( strtou_or_die( "0777", "test-pass-k"), 511 );
     
     //testUInt( strtou_or_die( "", "oops!a" ), 0 );  // will exit program
     //testUInt( strtou_or_die( "hi", "oops!b" ), 0 );  // will exit program
-    testUInt( strtou_or_die( "3hi", "oops!c" ), 3 );  // HEY -- this passes!  TODO: use the 2nd arg to strtol
+    //testUInt( strtou_or_die( "3hi", "oops!c" ), 0 );  // will exit program
     //testUInt( strtou_or_die( "7000000000", "oops!d" ), 0 );  // will exit program
     //testUInt( strtou_or_die( "-3000000000", "oops!e" ), 0 );  // will exit program
-    
-    
+
+    printTestMsg("\nTesting parse_*: ");
+    int parsedI = 99;
+    long parsedL = 99;
+    uint parsedU = 99;
+    ulong parsedUL = 99;
+    const char* stop;
+    stringConst threeHi = "3hi";
+    testInt( parse_i(threeHi, NULL, &parsedI, &stop), 0 );         testInt( parsedI, 3 );  testStr( stop, "hi" );
+    testInt( parse_i("3.9", NULL, &parsedI, &stop), 0 );           testStr( stop, ".9" );
+    testInt( parse_i("", NULL, &parsedI, NULL), EINVAL );
+    testInt( parse_i("-", NULL, &parsedI, NULL), EINVAL );
+    testInt( parse_i(" 5", NULL, &parsedI, NULL), EINVAL );
+    testInt( parse_i(threeHi, threeHi, &parsedI, &stop), EINVAL );  testStr( stop, "3hi" );
+    testInt( parse_i("12345678901234567", NULL, &parsedI, NULL), ERANGE );
+    testInt( parse_i("123456789", NULL, &parsedI, NULL), 0 );       testInt( parsedI, 123456789 );
+    testInt( parse_i("-000000000000000000042", NULL, &parsedI, NULL), 0 );  testInt( parsedI, -42 );
+    testInt( parse_i("2147483647", NULL, &parsedI, NULL), 0 );      testInt( parsedI, INT_MAX );
+    testInt( parse_i("-2147483648", NULL, &parsedI, NULL), 0 );     testInt( parsedI, INT_MIN );
+    testInt( parse_i("2147483648", NULL, &parsedI, NULL), ERANGE );
+    testInt( parse_i("-2147483649", NULL, &parsedI, NULL), ERANGE );
+    testInt( parse_u("4294967295", NULL, &parsedU, NULL), 0 );      testUInt( parsedU, UINT_MAX );
+    testInt( parse_u("4294967296", NULL, &parsedU, NULL), ERANGE );
+    testInt( parse_u("-1", NULL, &parsedU, NULL), ERANGE );
+    testInt( parse_u("-0", NULL, &parsedU, NULL), 0 );              testUInt( parsedU, 0 );
+    testInt( parse_l("-9223372036854775808", NULL, &parsedL, NULL), 0 );  testLong( parsedL, LONG_MIN );
+    testInt( parse_l("9223372036854775808", NULL, &parsedL, NULL), ERANGE );
+    testInt( parse_l("1234567890123456,7", NULL, &parsedL, &stop), 0 );  testLong( parsedL, 1234567890123456L );  testStr( stop, ",7" );
+    testInt( parse_ul("18446744073709551615", NULL, &parsedUL, NULL), 0 );  testBool( parsedUL == ULONG_MAX, true );
+    testInt( parse_ul("18446744073709551616", NULL, &parsedUL, NULL), ERANGE );
+    testInt( parse_ul("99999999999999999999999999", NULL, &parsedUL, &stop), ERANGE );  testStr( stop, "" );
+    // Compare against sprintf, near every power of 10 (exercising the 8-at-a-time path at each length):
+    bool allParsed = true;
+    for (ulong p=1;  p <= 1000000000000000000UL;  p *= 10) {
+        for (long d = -1;  d <= 1;  ++d) {
+            long const val = (long)p + d;
+            longToString_into( -val, numeral, sizeof(numeral) );
+            allParsed = allParsed && parse_l(numeral, NULL, &parsedL, NULL) == 0 && parsedL == -val;
+            }
+        }
+    testBool( allParsed, true );
+
+    int parsedArr[16];
+    stringConst csv = " 3, -4,5\n17 ,\n";
+    testLong( parseArrayI(csv, strlen(csv), ',', parsedArr), 4 );
+    testStr( arrI_toString(parsedArr, 4, NULL, NULL, NULL, NULL), "[3,-4,5,17]" );
+    stringConst wsv = "10 20\t30\n  40";
+    testLong( parseArrayI(wsv, strlen(wsv), ' ', parsedArr), 4 );
+    testInt( parsedArr[3], 40 );
+    testLong( parseArrayI("", 0, ',', parsedArr), 0 );
+    testLong( parseArrayI("1,,2", 4, ',', parsedArr), -1 );
+    testInt( errno, EINVAL );
+    testLong( parseArrayI("1,3hi", 5, ',', parsedArr), -1 );
+    testLong( parseArrayI("1,9999999999", 12, ',', parsedArr), -1 );
+    testInt( errno, ERANGE );
+    testLong( parseArrayI("1,2,345", 5, ',', parsedArr), 3 );  // stops at len, mid-numeral.
+    testInt( parsedArr[2], 3 );
+
+
+    printTestMsg("\nTesting strview: ");
+    stringConst logLine = "GET /index.html 200 5120";
+    strview const line = strview_fromStr(logLine);
+    strview const path = strview_sub(line, 4, 15);
+    testBool( strview_eq(path, strview_fromStr("/index.html")), true );
+    testBool( strview_eq(path, strview_fromStr("/index.htm")), false );
+    testBool( strview_eq(strview_of(NULL,0), strview_fromStr("")), true );
+    testBool( strview_compare(path, strview_fromStr("/index.html")) == 0, true );
+    testBool( strview_compare(path, strview_fromStr("/index.htm"))   > 0, true );
+    testBool( strview_compare(path, strview_fromStr("/index.htmx"))  < 0, true );
+    testBool( strview_compare(strview_fromStr("\xff"), strview_fromStr("a")) > 0, true );  // unsigned, like strcmp
+    testBool( strview_startsWith(line, strview_fromStr("GET ")), true );
+    testBool( strview_startsWith(path, strview_fromStr("/index.html!")), false );
+    testBool( strview_endsWith(line, strview_fromStr("5120")), true );
+    testBool( strview_endsWith(path, strview_fromStr("200")), false );  // (it's just past the view's end)
+    testLong( strview_findChar(line, ' '), 3 );
+    testLong( strview_findChar(path, ' '), -1 );
+    testLong( strview_find(line, strview_fromStr("200")), 16 );
+    testLong( strview_find(line, strview_fromStr("2000")), -1 );
+    testLong( strview_find(line, strview_fromStr("")), 0 );
+    testLong( strview_find(strview_fromStr("aaab"), strview_fromStr("aab")), 1 );
+    testLong( strview_find(path, strview_fromStr("html ")), -1 );
+    // findChar, for every length and match-position around the block sizes (and never reading past the view):
+    char haystack[100];
+    bool allFound = true;
+    for (size_t len = 0;  len <= 80;  ++len) {
+        for (size_t at = 0;  at <= len;  ++at) {  // at==len: no match
+            memset(haystack, '.', sizeof(haystack));
+            haystack[at] = '!';
+            haystack[len] = '!';  // just past the view
+            if (at+1 < len) haystack[len-1] = '!';  // a later match, too
+            long const expected = (at < len)  ?  (long)at  :  -1;
+            allFound = allFound && strview_findChar(strview_of(haystack, len), '!') == expected;
+            }
+        }
+    testBool( allFound, true );
+
+    strviewSplit fields = strview_split(line, ' ');
+    strview field;
+    int nFields = 0;
+    long fieldSum = 0;
+    while (strview_nextField(&fields, &field)) {
+        long val;
+        if (strview_to_long(field, &val) == 0) fieldSum += val;
+        ++nFields;
+        }
+    testInt( nFields, 4 );
+    testLong( fieldSum, 5320 );
+    testBool( strview_nextField(&fields, &field), false );
+    fields = strview_split(strview_fromStr("a,,b,"), ',');
+    stringConst expectedFields[] = { "a", "", "b", "" };
+    bool fieldsMatch = true;
+    nFields = 0;
+    while (strview_nextField(&fields, &field)) {
+        fieldsMatch = fieldsMatch  &&  nFields < 4  &&  strview_eq(field, strview_fromStr(expectedFields[nFields]));
+        ++nFields;
+        }
+    testBool( fieldsMatch, true );
+    testInt( nFields, 4 );
+    fields = strview_split(strview_fromStr(""), ',');
+    testBool( strview_nextField(&fields, &field), true );
+    testLong( (long)field.len, 0 );
+    testBool( strview_nextField(&fields, &field), false );
+
+    stringConst digitsThenMore = "-123456789012";
+    parsedI = 99;
+    testInt( strview_to_int(strview_of(digitsThenMore, 4), &parsedI), 0 );  testInt( parsedI, -123 );  // no null needed
+    testInt( strview_to_int(strview_of(digitsThenMore, 13), &parsedI), ERANGE );  testInt( parsedI, -123 );
+    testInt( strview_to_long(strview_of(digitsThenMore, 13), &parsedL), 0 );  testLong( parsedL, -123456789012L );
+    testInt( strview_to_int(strview_fromStr("12x"), &parsedI), EINVAL );  testInt( parsedI, -123 );
+    testInt( strview_to_int(strview_fromStr(" 12"), &parsedI), EINVAL );
+    testInt( strview_to_int(strview_fromStr("+"), &parsedI), EINVAL );
+    testInt( strview_to_int(strview_of(NULL, 0), &parsedI), EINVAL );
+
+
     printTestMsg("\nTesting sgn, monus, mod: ");
     testDouble( sgn(0), 0 );
     testDouble( sgn(-0), 0 );
@@ -158,6 +470,40 @@ int main() {
     testInt( modPos(INT_MIN, -2), 0 );
     testInt( modPos(INT_MIN+1, -2), -1 );
 
+    // modPos_by must agree with modPos, for every sign of n and b, and at the extremes:
+    int const divisors[] = { 1, 2, 3, 7, 10, 64, 1000, 65537, INT_MAX, -1, -2, -3, -7, -10, -64, -65537, INT_MIN, INT_MIN+1 };
+    int const numerators[] = { 0, 1, -1, 2, -2, 7, -7, 9, -9, 63, 64, -64, 65, 99999, -99999,
+                               INT_MAX, INT_MAX-1, INT_MIN, INT_MIN+1, 1<<30, -(1<<30) };
+    int const nDivisors = sizeof(divisors)/sizeof(divisors[0]);
+    int const nNumerators = sizeof(numerators)/sizeof(numerators[0]);
+    bool allAgree = true;
+    for (int i=0;  i<nDivisors;  ++i) {
+        moddiv_t div;
+        moddiv_init( &div, divisors[i] );
+        for (int j=0;  j<nNumerators;  ++j) {
+            int const n = numerators[j],  b = divisors[i];
+            if (b == -1 && n == INT_MIN) continue;  // (INT_MIN % -1 overflows.)
+            int const expect = modPos(n, b);
+            if (modPos_by(n, &div) != expect) {
+                allAgree = false;
+                printTestMsg("modPos_by(%d,%d) = %d; expected %d\n", n, b, modPos_by(n, &div), expect);
+                }
+            }
+        }
+    testBool( allAgree, true );
+    moddiv_t byThree;
+    moddiv_init( &byThree, 3 );
+    testInt( modPos_by(-8, &byThree), 1 );
+    testInt( modPos_by(INT_MIN, &byThree), modPos(INT_MIN, 3) );
+    int modArr[] = { -8, -3, -1, 0, 1, 5, INT_MAX, INT_MIN, 17 };
+    int modArrOut[9];
+    modPosArr( modArr, 9, -3, modArrOut );
+    for (int i=0;  i<9;  ++i) { testInt( modArrOut[i], modPos(modArr[i], -3) ); }
+    modPosArr( modArr, 9, 7, modArr );  // in place
+    testInt( modArr[0], 6 );
+    testInt( modArr[6], INT_MAX % 7 );
+    testInt( modArr[8], 3 );
+
     testLong( lmodPos(0,3), 0 );
     testLong( lmodPos(3,3), 0 );
     testLong( lmodPos(6,3), 0 );
@@ -254,6 +600,91 @@ int main() {
     testDouble( radToDeg(M_TAU), 360.0 );
     testDouble( radToDeg(M_PI),  180.0 );
     testDouble( radToDeg(M_PI/6), 30.0 );
+    static double const TWO_TAU = 2*M_TAU;  // (M_TAU is a compile-time constant)
+    testDouble( TWO_TAU, 4*M_PI );
+
+    printTestMsg("\nTesting fmodPos, angleNormalize: ");
+    testDouble( fmodPos( 7.5,  2), 1.5 );
+    testDouble( fmodPos(-7.5,  2), 0.5 );
+    testDouble( fmodPos( 7.5, -2), -0.5 );
+    testDouble( fmodPos(-7.5, -2), -1.5 );
+    testDouble( fmodPos(-4.0,  2), 0.0 );
+    testDouble( angleNormalize(0), 0 );
+    testDouble( angleNormalize(1), 1 );
+    testDouble( angleNormalize(M_TAU), 0 );
+    testDouble( angleNormalize(-0.25), M_TAU-0.25 );
+    testDouble( angleNormalize(3*M_TAU + 1), 1 );
+    testDouble( angleNormalize(-3*M_TAU + 1), 1 );
+    testDouble( angleNormalize(1e6), fmodPos(1e6, M_TAU) );
+    testDouble( angleNormalize(-1e6), fmodPos(-1e6, M_TAU) );
+    testBool( angleNormalize(-1e-300) < M_TAU, true );  // (not rounded up to tau itself)
+    testBool( angleNormalize(-1e-300) >= 0, true );
+    testDouble( angleNormalize(NAN), NAN );
+    testDouble( angleNormalizeSigned(M_PI), M_PI );
+    testDouble( angleNormalizeSigned(-M_PI), -M_PI );  // (the double M_PI is a hair less than pi, so -M_PI is in range.)
+    testDouble( angleNormalizeSigned(-1), -1 );
+    testDouble( angleNormalizeSigned(M_PI + 0.5), -M_PI + 0.5 );
+    testDouble( angleNormalizeSigned(-3*M_TAU - 0.5), -0.5 );
+
+    printTestMsg("\nTesting angle arrays: ");
+    const uint SZ_ANGLES = 1003;  // (not a multiple of the vector width)
+    double* angles = newArrayLf_rand( SZ_ANGLES, -1000, 1000 );
+    angles[0] = 0;
+    angles[1] = -1e-300;
+    angles[2] = M_PI;
+    angles[3] = -M_PI;
+    double* anglesOut = newArrayLf_uninit( SZ_ANGLES );
+    double* anglesExpect = newArrayLf_uninit( SZ_ANGLES );
+    float* anglesF = newArrayF_uninit( SZ_ANGLES );
+    float* anglesFOut = newArrayF_uninit( SZ_ANGLES );
+    for (uint i=0;  i<SZ_ANGLES;  ++i) { anglesF[i] = (float)angles[i]; }
+    bool anglesInRange = true,  anglesSame = true;
+
+    degToRadArr( angles, SZ_ANGLES, anglesOut );
+    for (uint i=0;  i<SZ_ANGLES;  ++i) { anglesExpect[i] = degToRad(angles[i]); }
+    testDoubleArray( anglesOut, anglesExpect, SZ_ANGLES );
+    radToDegArr( anglesOut, SZ_ANGLES, anglesOut );  // in place
+    testDoubleArray( anglesOut, angles, SZ_ANGLES );
+
+    angleNormalizeArr( angles, SZ_ANGLES, anglesOut );
+    for (uint i=0;  i<SZ_ANGLES;  ++i) {
+        anglesInRange = anglesInRange && 0 <= anglesOut[i] && anglesOut[i] < M_TAU;
+        anglesSame = anglesSame && anglesOut[i] == angleNormalize(angles[i]);
+        }
+    testBool( anglesInRange, true );
+    testBool( anglesSame, true );
+    angleNormalizeSignedArr( angles, SZ_ANGLES, anglesOut );
+    for (uint i=0;  i<SZ_ANGLES;  ++i) {
+        anglesInRange = anglesInRange && -M_PI < anglesOut[i] && anglesOut[i] <= M_PI;
+        anglesSame = anglesSame && anglesOut[i] == angleNormalizeSigned(angles[i]);
+        anglesExpect[i] = fmodPos(angles[i] + M_PI, M_TAU) - M_PI;
+        }
+    testBool( anglesInRange, true );
+    testBool( anglesSame, true );
+    testDouble( anglesOut[3], -M_PI );
+    testDoubleArray( anglesOut+4, anglesExpect+4, SZ_ANGLES-4 );
+
+    degToRadArrF( anglesF, SZ_ANGLES, anglesFOut );
+    testDouble( anglesFOut[2], degToRad((float)M_PI) );
+    radToDegArrF( anglesFOut, SZ_ANGLES, anglesFOut );
+    testFloatArray( anglesFOut, anglesF, SZ_ANGLES );
+    angleNormalizeArrF( anglesF, SZ_ANGLES, anglesFOut );
+    for (uint i=0;  i<SZ_ANGLES;  ++i) {
+        anglesInRange = anglesInRange && 0 <= anglesFOut[i] && anglesFOut[i] < (float)M_TAU;
+        // float has only ~7 digits;  anglesF[i] (up to 1000) is only known to within ~1e-4.
+        anglesSame = anglesSame && fabs(anglesFOut[i] - angleNormalize(anglesF[i])) < 1e-3;
+        }
+    angleNormalizeSignedArrF( anglesF, SZ_ANGLES, anglesFOut );
+    for (uint i=0;  i<SZ_ANGLES;  ++i) {
+        anglesInRange = anglesInRange && -(float)M_PI < anglesFOut[i] && anglesFOut[i] <= (float)M_PI;
+        }
+    testBool( anglesInRange, true );
+    testBool( anglesSame, true );
+    free(angles);
+    free(anglesOut);
+    free(anglesExpect);
+    free(anglesF);
+    free(anglesFOut);
    
     printTestMsg("\nTesting approxEquals: ");
     testBool( approxEquals(2.0, 2.0), true );
@@ -289,6 +720,258 @@ int main() {
     testBool( approxEquals(INFINITY, NAN), false );
     testBool( approxEquals(NAN, INFINITY), false );
 
+    printTestMsg("\nTesting approxEqualsArrD, approxEqualsArrF: ");
+    // Every pair of some awkward values, checked against approxEqualsRel:
+    double const awkward[] = { 0.0, -0.0, 1e-10, -1e-10, 2.0, 2.000000001, 2.1, -2.0, 1e308, -1e308, DBL_MAX,
+                               2.0e128, 2.000000001e128, INFINITY, -INFINITY, NAN, 17.0 };
+    uint const nAwkward = sizeof(awkward)/sizeof(awkward[0]);
+    uint const nPairs = nAwkward*nAwkward;
+    double* xsD = newArrayLf_uninit(nPairs);
+    double* ysD = newArrayLf_uninit(nPairs);
+    float* xsF = newArrayF_uninit(nPairs);
+    float* ysF = newArrayF_uninit(nPairs);
+    ulong expectBadD = 0, expectBadF = 0;
+    long expectFirstD = -1, expectFirstF = -1;
+    for (uint i=0;  i<nPairs;  ++i) {
+        xsD[i] = awkward[i/nAwkward];
+        ysD[i] = awkward[i%nAwkward];
+        xsF[i] = (float)xsD[i];
+        ysF[i] = (float)ysD[i];
+        if (!approxEqualsRel(xsD[i], ysD[i], 0.00001, 1e-9)) { if (expectBadD++ == 0) expectFirstD = i; }
+        if (!approxEqualsRel(xsF[i], ysF[i], 0.00001, 1e-9)) { if (expectBadF++ == 0) expectFirstF = i; }
+        }
+    // (after narrowing to float, 1e308 etc. are infinite -- and that's still what approxEqualsRel decides on.)
+    // Also:  try every tail-length, for the scalar leftovers after the vector loop.
+    for (uint n=0;  n<=nPairs;  n += (n < 20 ? 1 : 37)) {
+        arrMismatches const allD = approxEqualsArrD( xsD, ysD, n, 0.00001, 1e-9 );
+        arrMismatches const allF = approxEqualsArrF( xsF, ysF, n, 0.00001, 1e-9 );
+        ulong wantD = 0, wantF = 0;
+        for (uint i=0;  i<n;  ++i) {
+            wantD += !approxEqualsRel(xsD[i], ysD[i], 0.00001, 1e-9);
+            wantF += !approxEqualsRel(xsF[i], ysF[i], 0.00001, 1e-9);
+            }
+        testLong( (long)allD.count, (long)wantD );
+        testLong( (long)allF.count, (long)wantF );
+        }
+    arrMismatches const allD = approxEqualsArrD( xsD, ysD, nPairs, 0.00001, 1e-9 );
+    arrMismatches const allF = approxEqualsArrF( xsF, ysF, nPairs, 0.00001, 1e-9 );
+    testLong( (long)allD.count, (long)expectBadD );
+    testLong( allD.first, expectFirstD );
+    testLong( (long)allF.count, (long)expectBadF );
+    testLong( allF.first, expectFirstF );
+    testLong( approxEqualsArrD( xsD, xsD, 3, 0.00001, 1e-9 ).first, -1 );  // (0,0), (0,-0), (0,1e-10): all close.
+    free(xsD);
+    free(ysD);
+    free(xsF);
+    free(ysF);
+    double* bigD = newArrayLf_rand( 100003, -1e6, 1e6 );
+    double* bigD2 = newArrayLf_uninit( 100003 );
+    memcpy( bigD2, bigD, 100003*sizeof(double) );
+    testDoubleArray( bigD2, bigD, 100003 );
+    bigD2[99999] *= 1.001;
+    bigD2[100002] = NAN;
+    arrMismatches const two = approxEqualsArrD( bigD2, bigD, 100003, 0.00001, 1e-9 );
+    testLong( (long)two.count, 2 );
+    testLong( two.first, 99999 );
+    bigD[100002] = NAN;
+    bigD2[99999] = bigD[99999];
+    testDoubleArray( bigD2, bigD, 100003 );  // NaN matches NaN, as with testDouble.
+    free(bigD);
+    free(bigD2);
+    float const someFloats[] = { 1.0f, -2.5f, INFINITY, NAN };
+    testFloatArray( someFloats, someFloats, 4 );
+
+    printTestMsg("\nTesting ulpDistance: ");
+    testLong( (long)ulpDistance(1.0, 1.0), 0 );
+    testLong( (long)ulpDistance(1.0, nextafter(1.0, 2.0)), 1 );
+    testLong( (long)ulpDistance(nextafter(1.0, 2.0), 1.0), 1 );
+    testLong( (long)ulpDistance(1.0, nextafter(nextafter(1.0, 0.0), 0.0)), 2 );
+    testLong( (long)ulpDistance(-0.0, +0.0), 0 );
+    testLong( (long)ulpDistance(-DBL_TRUE_MIN, +DBL_TRUE_MIN), 2 );
+    testLong( (long)ulpDistance(-DBL_TRUE_MIN, 0.0), 1 );
+    testLong( (long)ulpDistance(DBL_MAX, INFINITY), 1 );
+    testLong( (long)ulpDistance(-DBL_MAX, -INFINITY), 1 );
+    testLong( (long)ulpDistance(-1.0, 1.0), (long)(2*ulpDistance(0.0, 1.0)) );
+    testBool( ulpDistance(NAN, 1.0) == ULONG_MAX, true );
+    testBool( ulpDistance(1.0, NAN) == ULONG_MAX, true );
+    testBool( ulpDistance(NAN, NAN) == ULONG_MAX, true );
+    testBool( ulpDistance(-INFINITY, INFINITY) < ULONG_MAX, true );
+    testUInt( ulpDistanceF(1.0f, nextafterf(1.0f, 2.0f)), 1 );
+    testUInt( ulpDistanceF(-0.0f, 0.0f), 0 );
+    testUInt( ulpDistanceF(-FLT_TRUE_MIN, FLT_TRUE_MIN), 2 );
+    testUInt( ulpDistanceF(FLT_MAX, INFINITY), 1 );
+    testUInt( ulpDistanceF(2.0f, NAN), UINT_MAX );
+    testUInt( ulpDistanceF(1.0f, 2.0f), 1u << 23 );
+    testBool( approxEqualsUlps(1.0, nextafter(1.0, 2.0), 1), true );
+    testBool( approxEqualsUlps(1.0, nextafter(nextafter(1.0, 2.0), 2.0), 1), false );
+    testBool( approxEqualsUlps(-0.0, 0.0, 0), true );
+    testBool( approxEqualsUlps(NAN, NAN, ULONG_MAX), false );
+    testBool( approxEqualsUlps(2.0, -2.0, 4*1024*1024), false );
+
+    printTestMsg("\nTesting ulpDistanceArr, ulpHistogram: ");
+    ulong const bucketOf[] = { 0, 1, 2, 4, 5, 16, 17, 64, 65 };  // distances at the edges of buckets 0,1,2,2,3,3,4,4,5
+    uint const expectBucket[] = { 0, 1, 2, 2, 3, 3, 4, 4, 5 };
+    uint const nEdges = sizeof(bucketOf)/sizeof(bucketOf[0]);
+    double ulpXs[10], ulpYs[10];
+    for (uint i=0;  i<nEdges;  ++i) {
+        ulpXs[i] = 1.0;
+        long ulpBits;
+        memcpy(&ulpBits, &ulpXs[i], sizeof(ulpBits));
+        ulpBits += (long)bucketOf[i];
+        memcpy(&ulpYs[i], &ulpBits, sizeof(ulpBits));
+        }
+    ulpXs[nEdges] = NAN;
+    ulpYs[nEdges] = 3.0;
+    ulong ulpDists[10];
+    ulpHistogram hist;
+    ulpHistogram_init(&hist);
+    ulpDistanceArr( ulpXs, ulpYs, nEdges+1, ulpDists, &hist );
+    for (uint i=0;  i<nEdges;  ++i) { testLong( (long)ulpDists[i], (long)bucketOf[i] ); }
+    testInt( (int)hist.total, (int)nEdges+1 );
+    testInt( (int)hist.counts[0], 1 );
+    testInt( (int)hist.counts[1], 1 );
+    testInt( (int)hist.counts[2], 2 );
+    testInt( (int)hist.counts[3], 2 );
+    testInt( (int)hist.counts[4], 2 );
+    testInt( (int)hist.counts[5], 1 );
+    testInt( (int)hist.counts[ULP_HISTOGRAM_BUCKETS-1], 1 );  // the NaN
+    testBool( hist.maxUlps == ULONG_MAX, true );
+    for (uint i=0;  i<nEdges;  ++i) {
+        testBool( ulpBucketLow(expectBucket[i]) <= bucketOf[i] && bucketOf[i] <= ulpBucketHigh(expectBucket[i]), true );
+        }
+    testLong( (long)ulpBucketLow(ULP_HISTOGRAM_BUCKETS-1), (long)(1UL << 62) + 1 );
+    testBool( ulpBucketHigh(ULP_HISTOGRAM_BUCKETS-1) == ULONG_MAX, true );
+    float ulpXsF[3] = { 1.0f, -0.0f, 5.0f };
+    float ulpYsF[3] = { nextafterf(1.0f, 0.0f), 0.0f, 5.0f };
+    uint ulpDistsF[3];
+    ulpDistanceArrF( ulpXsF, ulpYsF, 3, ulpDistsF, NULL );
+    testUInt( ulpDistsF[0], 1 );
+    testUInt( ulpDistsF[1], 0 );
+    ulpDistanceArrF( ulpXsF, ulpYsF, 3, NULL, &hist );  // accumulates.
+    testInt( (int)hist.total, (int)nEdges+1+3 );
+    testInt( (int)hist.counts[0], 3 );
+    testInt( (int)hist.counts[1], 2 );
+
+    printTestMsg("\nTesting sinArr, cosArr, sincosArr, atan2Arr: ");
+    const uint SZ_TRIG = 10007;
+    double* trigXs = newArrayLf_rand( SZ_TRIG, -1000, 1000 );
+    double* trigYs = newArrayLf_rand( SZ_TRIG, -10, 10 );
+    double* trigOut = newArrayLf_uninit( SZ_TRIG );
+    double* trigOut2 = newArrayLf_uninit( SZ_TRIG );
+    double* trigExpect = newArrayLf_uninit( SZ_TRIG );
+    float* trigXsF = newArrayF_uninit( SZ_TRIG );
+    float* trigYsF = newArrayF_uninit( SZ_TRIG );
+    float* trigOutF = newArrayF_uninit( SZ_TRIG );
+    float* trigExpectF = newArrayF_uninit( SZ_TRIG );
+    for (uint i=0;  i<SZ_TRIG;  ++i) { trigXsF[i] = (float)trigXs[i];  trigYsF[i] = (float)trigYs[i]; }
+    // TRIG_FAST and TRIG_MEDIUM promise an absolute error;  TRIG_FULL a few ulps.
+    double const trigAbsTol[] = { 1e-3, 1e-6 };
+    for (trigAccuracy acc = TRIG_FAST;  acc <= TRIG_MEDIUM;  ++acc) {
+        sinArr( trigXs, SZ_TRIG, trigOut, acc );
+        for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpect[i] = sin(trigXs[i]); }
+        testLong( (long)approxEqualsArrD( trigOut, trigExpect, SZ_TRIG, 0.0, trigAbsTol[acc] ).count, 0 );
+        cosArr( trigXs, SZ_TRIG, trigOut, acc );
+        for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpect[i] = cos(trigXs[i]); }
+        testLong( (long)approxEqualsArrD( trigOut, trigExpect, SZ_TRIG, 0.0, trigAbsTol[acc] ).count, 0 );
+        atan2Arr( trigYs, trigXs, SZ_TRIG, trigOut, acc );
+        for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpect[i] = atan2(trigYs[i], trigXs[i]); }
+        testLong( (long)approxEqualsArrD( trigOut, trigExpect, SZ_TRIG, 0.0, trigAbsTol[acc] ).count, 0 );
+        sinArrF( trigXsF, SZ_TRIG, trigOutF, acc );
+        for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpectF[i] = sinf(trigXsF[i]); }
+        testLong( (long)approxEqualsArrF( trigOutF, trigExpectF, SZ_TRIG, 0.0, 2*trigAbsTol[acc] ).count, 0 );
+        cosArrF( trigXsF, SZ_TRIG, trigOutF, acc );
+        for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpectF[i] = cosf(trigXsF[i]); }
+        testLong( (long)approxEqualsArrF( trigOutF, trigExpectF, SZ_TRIG, 0.0, 2*trigAbsTol[acc] ).count, 0 );
+        atan2ArrF( trigYsF, trigXsF, SZ_TRIG, trigOutF, acc );
+        for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpectF[i] = atan2f(trigYsF[i], trigXsF[i]); }
+        testLong( (long)approxEqualsArrF( trigOutF, trigExpectF, SZ_TRIG, 0.0, 2*trigAbsTol[acc] ).count, 0 );
+        }
+    // (float inputs only carry ~7 digits, so the float tolerances are a hair looser.)
+    ulpHistogram trigHist, trigHistF;
+    ulpHistogram_init(&trigHist);
+    ulpHistogram_init(&trigHistF);
+    sinArr( trigXs, SZ_TRIG, trigOut, TRIG_FULL );
+    for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpect[i] = sin(trigXs[i]); }
+    ulpDistanceArr( trigOut, trigExpect, SZ_TRIG, NULL, &trigHist );
+    cosArr( trigXs, SZ_TRIG, trigOut, TRIG_FULL );
+    for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpect[i] = cos(trigXs[i]); }
+    ulpDistanceArr( trigOut, trigExpect, SZ_TRIG, NULL, &trigHist );
+    atan2Arr( trigYs, trigXs, SZ_TRIG, trigOut, TRIG_FULL );
+    for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpect[i] = atan2(trigYs[i], trigXs[i]); }
+    ulpDistanceArr( trigOut, trigExpect, SZ_TRIG, NULL, &trigHist );
+    atan2Arr( trigXs, trigYs, SZ_TRIG, trigOut, TRIG_FULL );  // mostly-steep angles
+    for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpect[i] = atan2(trigXs[i], trigYs[i]); }
+    ulpDistanceArr( trigOut, trigExpect, SZ_TRIG, NULL, &trigHist );
+    sinArrF( trigXsF, SZ_TRIG, trigOutF, TRIG_FULL );
+    for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpectF[i] = sinf(trigXsF[i]); }
+    ulpDistanceArrF( trigOutF, trigExpectF, SZ_TRIG, NULL, &trigHistF );
+    cosArrF( trigXsF, SZ_TRIG, trigOutF, TRIG_FULL );
+    for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpectF[i] = cosf(trigXsF[i]); }
+    ulpDistanceArrF( trigOutF, trigExpectF, SZ_TRIG, NULL, &trigHistF );
+    atan2ArrF( trigYsF, trigXsF, SZ_TRIG, trigOutF, TRIG_FULL );
+    for (uint i=0;  i<SZ_TRIG;  ++i) { trigExpectF[i] = atan2f(trigYsF[i], trigXsF[i]); }
+    ulpDistanceArrF( trigOutF, trigExpectF, SZ_TRIG, NULL, &trigHistF );
+    testBool( trigHist.maxUlps <= 4, true );
+    testBool( trigHistF.maxUlps <= 4, true );
+    if (trigHist.maxUlps > 4) printUlpHistogram( stderr, &trigHist );
+    if (trigHistF.maxUlps > 4) printUlpHistogram( stderr, &trigHistF );
+
+    sincosArr( trigXs, SZ_TRIG, trigOut, trigOut2, TRIG_MEDIUM );
+    cosArr( trigXs, SZ_TRIG, trigExpect, TRIG_MEDIUM );
+    testDoubleArray( trigOut2, trigExpect, SZ_TRIG );
+    sinArr( trigXs, SZ_TRIG, trigExpect, TRIG_MEDIUM );
+    testDoubleArray( trigOut, trigExpect, SZ_TRIG );
+    memcpy( trigOut, trigXs, SZ_TRIG*sizeof(double) );
+    sinArr( trigOut, SZ_TRIG, trigOut, TRIG_FULL );  // in place
+    sinArr( trigXs, SZ_TRIG, trigExpect, TRIG_FULL );
+    testDoubleArray( trigOut, trigExpect, SZ_TRIG );
+    // Odd lengths, for the scalar leftovers:
+    for (uint n=0;  n<20;  ++n) {
+        trigOut[n] = 99.0;
+        sinArr( trigXs, n, trigOut, TRIG_FULL );
+        testDouble( trigOut[n], 99.0 );  // (untouched past the end)
+        testDoubleArray( trigOut, trigExpect, n );
+        }
+
+    double const trigEdges[] = { 0.0, -0.0, INFINITY, -INFINITY, NAN, 1e7, -3e9, M_PI/2, 1e-300 };
+    uint const nTrigEdges = sizeof(trigEdges)/sizeof(trigEdges[0]);
+    double trigEdgeOut[sizeof(trigEdges)/sizeof(trigEdges[0])];
+    double trigEdgeOut2[sizeof(trigEdges)/sizeof(trigEdges[0])];
+    double trigEdgeExpect[sizeof(trigEdges)/sizeof(trigEdges[0])];
+    double trigEdgeExpect2[sizeof(trigEdges)/sizeof(trigEdges[0])];
+    sincosArr( trigEdges, nTrigEdges, trigEdgeOut, trigEdgeOut2, TRIG_FULL );
+    for (uint i=0;  i<nTrigEdges;  ++i) {
+        trigEdgeExpect[i] = sin(trigEdges[i]);
+        trigEdgeExpect2[i] = cos(trigEdges[i]);
+        }
+    testDoubleArray( trigEdgeOut, trigEdgeExpect, nTrigEdges );  // (1e7 and -3e9 go through libm)
+    testDoubleArray( trigEdgeOut2, trigEdgeExpect2, nTrigEdges );
+    double const atanYs[] = { 0.0, -0.0,  0.0, -0.0, 1.0, -1.0, INFINITY,  INFINITY, -INFINITY, 1e-300, 1e300,  NAN, 1.0 };
+    double const atanXs[] = { 0.0,  0.0, -0.0, -0.0, 0.0, -0.0, INFINITY, -INFINITY,  5.0,      -1.0,   1e-300, 1.0, NAN };
+    uint const nAtanEdges = sizeof(atanYs)/sizeof(atanYs[0]);
+    double atanEdgeOut[sizeof(atanYs)/sizeof(atanYs[0])];
+    double atanEdgeExpect[sizeof(atanYs)/sizeof(atanYs[0])];
+    for (trigAccuracy acc = TRIG_FAST;  acc <= TRIG_FULL;  ++acc) {
+        atan2Arr( atanYs, atanXs, nAtanEdges, atanEdgeOut, acc );
+        bool signsAgree = true;
+        for (uint i=0;  i<nAtanEdges;  ++i) {
+            atanEdgeExpect[i] = atan2(atanYs[i], atanXs[i]);
+            signsAgree = signsAgree && (signbit(atanEdgeOut[i]) == signbit(atanEdgeExpect[i]));
+            }
+        testLong( (long)approxEqualsArrD( atanEdgeOut, atanEdgeExpect, nAtanEdges-2, 0.0, acc==TRIG_FULL ? 1e-15 : 1e-3 ).count, 0 );
+        testBool( isnan(atanEdgeOut[nAtanEdges-2]) && isnan(atanEdgeOut[nAtanEdges-1]), true );
+        testBool( signsAgree, true );
+        }
+    free(trigXs);
+    free(trigYs);
+    free(trigOut);
+    free(trigOut2);
+    free(trigExpect);
+    free(trigXsF);
+    free(trigYsF);
+    free(trigOutF);
+    free(trigExpectF);
+
     printTestMsg("\nTesting arrT_toString: ");
     int* arr5i = malloc(5*sizeof(int));
     arr5i[0] = 7;
@@ -312,7 +995,50 @@ int main() {
              "[+03.1,+00.0,-02.7]" );
     testStr( arrC_toString("hello", 3, "", "%c", "", ""),
              "hel" );
-  
+    testStr( arrI_toString(arr5i, 0, NULL, NULL, NULL, NULL),
+             "[]" );
+    stringOnHeap = (char*) arrI_toString(arr5i, 1, "", "%0300d", "", "");  // longer than any one-element guess
+    testUInt( (uint)strlen(stringOnHeap), 300u );
+    testStr( stringOnHeap+297, "007" );
+    free(stringOnHeap);
+    const uint SZ_BIG = 100000;
+    int* bigArr = newArrayI( SZ_BIG, 5 );
+    stringOnHeap = (char*) arrI_toString(bigArr, (int)SZ_BIG, NULL, NULL, NULL, NULL);
+    testUInt( (uint)strlen(stringOnHeap), 2*SZ_BIG+1 );
+    free(stringOnHeap);
+
+    printTestMsg("\nTesting arrT_write: ");
+    char readBack[64];
+    FILE* tmp = tmpfile();
+    testLong( arrI_write(tmp, arr5i, 3, "<", NULL, " : ", ">"), 15 );
+    rewind(tmp);
+    readBack[ fread(readBack, 1, sizeof(readBack)-1, tmp) ] = '\0';
+    testStr( readBack, "<7 : 22 : -307>" );
+    fclose(tmp);
+    tmp = tmpfile();
+    testLong( arrLf_writeFd(fileno(tmp), arr3d, 3, NULL, "%+05.1lf", NULL, NULL), 19 );
+    lseek(fileno(tmp), 0, SEEK_SET);
+    readBack[ read(fileno(tmp), readBack, sizeof(readBack)-1) ] = '\0';
+    testStr( readBack, "[+03.1,+00.0,-02.7]" );
+    fclose(tmp);
+    // Many chunks' worth (and one element bigger than a chunk); should match arrI_toString exactly.
+    tmp = tmpfile();
+    bigArr[SZ_BIG/2] = -1;
+    stringOnHeap = (char*) arrI_toString(bigArr, (int)SZ_BIG, NULL, NULL, NULL, NULL);
+    testLong( arrI_writeFd(fileno(tmp), bigArr, (int)SZ_BIG, NULL, NULL, NULL, NULL), (long)strlen(stringOnHeap) );
+    char* bigReadBack = malloc( strlen(stringOnHeap)+1 );
+    lseek(fileno(tmp), 0, SEEK_SET);
+    bigReadBack[ read(fileno(tmp), bigReadBack, strlen(stringOnHeap)) ] = '\0';
+    testStr( bigReadBack, stringOnHeap );
+    free(bigReadBack);
+    free(stringOnHeap);
+    fclose(tmp);
+    testLong( arrI_writeFd(-1, arr5i, 3, NULL, NULL, NULL, NULL), -1 );  // bad fd.
+    tmp = tmpfile();
+    testLong( arrI_write(tmp, arr5i, 1, "", "%020000d", "", ""), 20000 );
+    fclose(tmp);
+    free(bigArr);
+
 
     
     printTestMsg("\nTesting array init/fill");
@@ -344,6 +1070,625 @@ int main() {
     
     
     
+    printTestMsg("\nTesting runBench: ");
+    bench_sampleCount = 11;
+    bench_sampleNsec = 100000UL;
+    bench_warmupNsec = 0UL;
+    int numBenches;
+    registerBench("sumTo", benchSumTo, 1000);
+    const benchCase* benches = registeredBenches(&numBenches);
+    testInt( numBenches, 1 );
+    benchResult const r = runBench(&benches[0]);
+    testStr( r.name, "sumTo" );
+    testUInt( r.samples, 11u );
+    testBool( r.itersPerSample >= 1, true );
+    testBool( 0.0 < r.minNsec  &&  r.minNsec <= r.medianNsec  &&  r.medianNsec <= r.p99Nsec, true );
+    FILE* jsonOut = tmpfile();
+    benchResult twoResults[] = { r, r };
+    char twoName[] = "two";
+    twoResults[1].name = twoName;
+    printBenchResults_json( jsonOut, twoResults, 2 );
+    rewind(jsonOut);
+    int numRead;
+    benchResult* readIn = readBenchResults_json( jsonOut, &numRead );
+    fclose(jsonOut);
+    testInt( numRead, 2 );
+    testStr( readIn[1].name, "two" );
+    testBool( approxEqualsRel( readIn[0].medianNsec, r.medianNsec, 0.001, 0.001 ), true );
+    readIn[0].medianNsec = r.medianNsec * 2;  // so, r is 50% faster...
+    readIn[1].medianNsec = r.medianNsec / 2;  // ...and 100% slower.
+    FILE* devNull = fopen("/dev/null", "w");
+    testInt( printBenchComparison( devNull, readIn, numRead, twoResults, 2, 10.0 ), 1 );
+    testInt( printBenchComparison( devNull, readIn, numRead, twoResults, 2, 200.0 ), 0 );
+    testInt( printBenchComparison( devNull, readIn, 0, twoResults, 2, 10.0 ), 0 );  // all new.
+    fclose(devNull);
+    freeBenchResults( readIn, numRead );
+    free(r.name);
+
+    printTestMsg("\nTesting runTestCases: ");
+    int const runBefore = testsRun();
+    int const failedBefore = testsFailed();
+    print_on_test_success = false;
+    int const casesFailed = runTestCases( 4, "parallelCount" );
+    print_on_test_success = true;
+    testInt( casesFailed, 0 );
+    testInt( testsRun() - runBefore, 4*PARALLEL_COUNT_TESTS + 1 );
+    testInt( testsFailed() - failedBefore, 0 );
+
+    printTestMsg("\nTesting rng: ");
+    rngState rng = { { 1, 2, 3, 4 } };  // reference outputs, from the xoshiro256** authors' code.
+    testBool( rng_next(&rng) == 11520UL, true );
+    testBool( rng_next(&rng) == 0UL, true );
+    testBool( rng_next(&rng) == 1509978240UL, true );
+    testBool( rng_next(&rng) == 1215971899390074240UL, true );
+    rngState rng2;
+    rng_seed(&rng, 99);
+    rng_seed(&rng2, 99);
+    bool sameStream = true;
+    for (int k=0;  k<100;  ++k) { sameStream = sameStream && (rng_next(&rng) == rng_next(&rng2)); }
+    testBool( sameStream, true );
+    testUInt( rng_below(&rng, 1), 0u );
+    bool inRange = true;
+    for (int k=0;  k<1000;  ++k) {
+        int const r = rng_rangeI(&rng, INT_MIN, INT_MAX);   // a range of more than INT_MAX values.
+        inRange = inRange && r != INT_MAX;
+        int const small = rng_rangeI(&rng, -3, -1);
+        inRange = inRange && (small == -3 || small == -2);
+        }
+    testBool( inRange, true );
+    const uint SZ_RAND = 100000;
+    int* randArr = newArrayI_uninit(SZ_RAND);
+    rng_fillI( &rng, randArr, SZ_RAND, 10, 20 );
+    int buckets[10] = { 0 };
+    for (uint k=0;  k<SZ_RAND;  ++k) { ++buckets[randArr[k]-10]; }
+    bool evenish = true;
+    for (int b=0;  b<10;  ++b) { evenish = evenish && abs(buckets[b] - (int)SZ_RAND/10) < (int)SZ_RAND/100; }
+    testBool( evenish, true );
+    rng_seedDefault(7);
+    int firstDraw = fillArrayI_rand(randArr, 5, 0, 1000000)[4];
+    rng_seedDefault(7);
+    testInt( fillArrayI_rand(randArr, 5, 0, 1000000)[4], firstDraw );  // reproducible.
+    free(randArr);
+
+    printTestMsg("\nTesting typed arrays: ");
+    bool allFilled = true;
+    for (uint len=1;  len<=70;  ++len) {  // every tail-length, for each vector width
+        char* cs = newArrayC( len+2, 'x' );
+        fillArrayC( cs+1, len, 'q' );
+        long* ls = newArrayLi( len+2, -1L );
+        fillArrayLi( ls+1, len, LONG_MIN );
+        double* ds = newArrayLf( len+2, 0.0 );
+        fillArrayLf( ds+1, len, -2.5 );
+        allFilled = allFilled && cs[0]=='x' && cs[len+1]=='x' && ls[0]==-1L && ls[len+1]==-1L && ds[0]==0.0 && ds[len+1]==0.0;
+        for (uint k=1;  k<=len;  ++k) { allFilled = allFilled && cs[k]=='q' && ls[k]==LONG_MIN && ds[k]==-2.5; }
+        free(cs);
+        free(ls);
+        free(ds);
+        }
+    testBool( allFilled, true );
+    const uint SZ_HUGE = 5000001;
+    fill_streamingBytes = 1UL<<20;  // so that SZ_HUGE floats are big enough to use streaming stores.
+    float* hugeFloats = newArrayF_uninit( SZ_HUGE+1 );
+    hugeFloats[0] = 7.0f;
+    fillArrayF( hugeFloats+1, SZ_HUGE, 1.5f );  // (deliberately unaligned)
+    bool hugeFilled = (hugeFloats[0] == 7.0f);
+    for (uint k=1;  k<=SZ_HUGE;  ++k) { hugeFilled = hugeFilled && hugeFloats[k]==1.5f; }
+    testBool( hugeFilled, true );
+    fill_streamingBytes = 0;
+    free(hugeFloats);
+    bool* flags = newArrayB( 33, true );
+    testBool( flags[0] && flags[32], true );
+    fillArrayB_rand( flags, 33 );
+    bool sawTrue = false, sawFalse = false;
+    for (int k=0;  k<33;  ++k) { sawTrue = sawTrue || flags[k];  sawFalse = sawFalse || !flags[k]; }
+    testBool( sawTrue && sawFalse, true );
+    free(flags);
+    double* aligned = newArrayLf_aligned( 10, 0 );
+    testBool( (uintptr_t)aligned % 64 == 0, true );
+    free(aligned);
+    int* aligned4k = newArrayI_aligned( 10, 4096 );
+    testBool( (uintptr_t)aligned4k % 4096 == 0, true );
+    free(aligned4k);
+    const uint SZ_R = 1000;
+    long* randLongs = newArrayLi_rand( SZ_R, LONG_MIN, LONG_MAX );
+    double* randDoubles = newArrayLf_rand( SZ_R, -1.0, 1.0 );
+    char* randChars = newArrayC_rand( SZ_R, 'a', 'd' );
+    float* randFloats = newArrayF_rand( SZ_R, 10.0f, 10.5f );
+    bool randsInRange = true;
+    bool sawBigLong = false;
+    for (uint k=0;  k<SZ_R;  ++k) {
+        randsInRange = randsInRange && randLongs[k] != LONG_MAX
+                                    && -1.0 <= randDoubles[k] && randDoubles[k] < 1.0
+                                    && 'a' <= randChars[k] && randChars[k] < 'd'
+                                    && 10.0f <= randFloats[k] && randFloats[k] < 10.5f;
+        sawBigLong = sawBigLong || randLongs[k] > (1L << 60) || randLongs[k] < -(1L << 60);
+        }
+    testBool( randsInRange, true );
+    testBool( sawBigLong, true );
+    free(randLongs);
+    free(randDoubles);
+    free(randChars);
+    free(randFloats);
+
+    printTestMsg("\nTesting parallel fills: ");
+    const ulong SZ_PAR = 3*65536 + 12345;  // several blocks, and a partial one.
+    int* par1 = newArrayI_rand_par( SZ_PAR, -50, 50, 2024, 1 );
+    int* par3 = newArrayI_rand_par( SZ_PAR, -50, 50, 2024, 3 );
+    int* par8 = newArrayI_rand_par( SZ_PAR, -50, 50, 2024, 8 );
+    testBool( memcmp(par1, par3, SZ_PAR*sizeof(int)) == 0, true );  // same, regardless of #threads
+    testBool( memcmp(par1, par8, SZ_PAR*sizeof(int)) == 0, true );
+    bool parInRange = true;
+    for (ulong k=0;  k<SZ_PAR;  ++k) { parInRange = parInRange && -50 <= par1[k] && par1[k] < 50; }
+    testBool( parInRange, true );
+    testBool( memcmp(par1, par1 + 65536, 1000*sizeof(int)) != 0, true );  // blocks get different streams.
+    fillArrayI_rand_par( par3, SZ_PAR, -50, 50, 2025, 0 );
+    testBool( memcmp(par1, par3, SZ_PAR*sizeof(int)) != 0, true );
+    fillArrayI_par( par8, SZ_PAR, 17, 0 );
+    bool allSeventeen = true;
+    for (ulong k=0;  k<SZ_PAR;  ++k) { allSeventeen = allSeventeen && par8[k]==17; }
+    testBool( allSeventeen, true );
+    free(par1);
+    free(par3);
+    free(par8);
+    int* parTiny = newArrayI_par( 3, -1, 4 );
+    testInt( parTiny[2], -1 );
+    free(parTiny);
+
+    printTestMsg("\nTesting newArrayI_fromFile, newArrayLf_fromFile: ");
+    char numsPath[] = "/tmp/ibarland-utils-test-XXXXXX";
+    int const numsFd = mkstemp(numsPath);
+    assert(numsFd >= 0);
+    close(numsFd);
+    ulong numsCount = 99;
+    writeTestFile(numsPath, "3, -4,5\n17\n");
+    int* fileInts = newArrayI_fromFile(numsPath, &numsCount);
+    testLong( (long)numsCount, 4 );
+    testStr( arrI_toString(fileInts, (int)numsCount, NULL, NULL, NULL, NULL), "[3,-4,5,17]" );
+    free(fileInts);
+    // Lots of numerals, with every mix of separators, cut into chunks of every small size (and the default):
+    strBuilder numsText;
+    sb_init(&numsText);
+    stringConst seps[] = { ",", " ", "\n", ", ", "\t\t", ",\r\n" };
+    int* fileExpected = newArrayI_uninit(5000);
+    rng_seedDefault(23);
+    fillArrayI_rand(fileExpected, 5000, -2000000000, 2000000000);
+    for (int k=0;  k<5000;  ++k) { sb_appendf(&numsText, "%s%d", seps[k%6], fileExpected[k]); }
+    char* const numsStr = sb_finish(&numsText);
+    writeTestFile(numsPath, numsStr);
+    free(numsStr);
+    size_t const defaultChunkBytes = fromFile_chunkBytes;
+    size_t const chunkSizes[] = { 1, 2, 7, 64, 1000, defaultChunkBytes };
+    bool allLoaded = true;
+    for (size_t k=0;  k<SIZEOF_ARRAY(chunkSizes);  ++k) {
+        fromFile_chunkBytes = chunkSizes[k];
+        fileInts = newArrayI_fromFile(numsPath, &numsCount);
+        allLoaded = allLoaded && fileInts != NULL && numsCount == 5000 && memcmp(fileInts, fileExpected, 5000*sizeof(int)) == 0;
+        free(fileInts);
+        }
+    testBool( allLoaded, true );
+    fromFile_chunkBytes = 3;
+    double* fileDoubles = newArrayLf_fromFile(numsPath, &numsCount);
+    testLong( (long)numsCount, 5000 );
+    testDouble( fileDoubles[4999], fileExpected[4999] );
+    free(fileDoubles);
+    free(fileExpected);
+    writeTestFile(numsPath, "1.5 -2e3\n0x1p4,inf  nan\t1e-320,-0\n");
+    double const expectedDoubles[] = { 1.5, -2e3, 16.0, INFINITY, NAN, 1e-320, -0.0 };
+    fileDoubles = newArrayLf_fromFile(numsPath, &numsCount);
+    testLong( (long)numsCount, 7 );
+    testDoubleArray( fileDoubles, expectedDoubles, 7 );
+    free(fileDoubles);
+    fromFile_chunkBytes = defaultChunkBytes;
+    // Malformed files:
+    writeTestFile(numsPath, "1 2x 3");
+    errno = 0;
+    testBool( newArrayI_fromFile(numsPath, &numsCount) == NULL, true );  testInt( errno, EINVAL );
+    testBool( newArrayLf_fromFile(numsPath, &numsCount) == NULL, true );  testInt( errno, EINVAL );
+    writeTestFile(numsPath, "1 2.5");
+    testBool( newArrayI_fromFile(numsPath, &numsCount) == NULL, true );  testInt( errno, EINVAL );
+    writeTestFile(numsPath, "7\n2147483648\n");
+    testBool( newArrayI_fromFile(numsPath, &numsCount) == NULL, true );  testInt( errno, ERANGE );
+    writeTestFile(numsPath, "7 1e999");
+    testBool( newArrayLf_fromFile(numsPath, &numsCount) == NULL, true );  testInt( errno, ERANGE );
+    writeTestFile(numsPath, "");
+    fileInts = newArrayI_fromFile(numsPath, &numsCount);
+    testBool( fileInts != NULL, true );  testLong( (long)numsCount, 0 );
+    free(fileInts);
+    writeTestFile(numsPath, " ,\n ");
+    fileInts = newArrayI_fromFile(numsPath, &numsCount);
+    testBool( fileInts != NULL, true );  testLong( (long)numsCount, 0 );
+    free(fileInts);
+    unlink(numsPath);
+    testBool( newArrayI_fromFile(numsPath, &numsCount) == NULL, true );  testInt( errno, ENOENT );
+
+    printTestMsg("\nTesting saveArrayX, mapArrayX: ");
+    char binPath[] = "/tmp/ibarland-utils-test-XXXXXX";
+    int const binFd = mkstemp(binPath);
+    assert(binFd >= 0);
+    close(binFd);
+    double const savedDoubles[] = { 1.0/3, -0.0, NAN, INFINITY, DBL_MIN/4, DBL_MAX, -1e-300 };  // (not one of them survives "%f")
+    ulong binCount = 99;
+    testLong( saveArrayLf(binPath, savedDoubles, 7), 64 + 7*sizeof(double) );
+    const double* mappedDoubles = mapArrayLf(binPath, &binCount);
+    testLong( (long)binCount, 7 );
+    testBool( memcmp(mappedDoubles, savedDoubles, sizeof(savedDoubles)) == 0, true );  // bit-for-bit
+    testBool( (uintptr_t)mappedDoubles % 64 == 0, true );
+    unmapArray(mappedDoubles);
+    int* savedInts = newArrayI_rand(100000, INT_MIN, INT_MAX);
+    saveArrayI(binPath, savedInts, 100000);
+    const int* mappedInts = mapArrayI(binPath, &binCount);
+    testLong( (long)binCount, 100000 );
+    testBool( memcmp(mappedInts, savedInts, 100000*sizeof(int)) == 0, true );
+    unmapArray(mappedInts);
+    free(savedInts);
+    long const savedLongs[] = { LONG_MIN, -1, 0, LONG_MAX };
+    saveArrayLi(binPath, savedLongs, 4);
+    const long* mappedLongs = mapArrayLi(binPath, &binCount);
+    testLong( mappedLongs[0], LONG_MIN );  testLong( mappedLongs[3], LONG_MAX );
+    unmapArray(mappedLongs);
+    // Re-saving over a file that's mapped leaves the mapping alone (the save makes a new file):
+    long const resavedLongs[] = { 7, 8 };
+    mappedLongs = mapArrayLi(binPath, &binCount);
+    testLong( saveArrayLi(binPath, resavedLongs, 2), 64 + 2*sizeof(long) );
+    testLong( mappedLongs[0], LONG_MIN );  testLong( mappedLongs[3], LONG_MAX );
+    unmapArray(mappedLongs);
+    mappedLongs = mapArrayLi(binPath, &binCount);
+    testLong( (long)binCount, 2 );  testLong( mappedLongs[1], 8 );
+    unmapArray(mappedLongs);
+    bool const savedBools[] = { true, false, true };
+    saveArrayB(binPath, savedBools, 3);
+    const bool* mappedBools = mapArrayB(binPath, &binCount);
+    testLong( (long)binCount, 3 );  testBool( mappedBools[2], true );
+    unmapArray(mappedBools);
+    saveArrayC(binPath, "", 0);
+    const char* mappedChars = mapArrayC(binPath, &binCount);
+    testBool( mappedChars != NULL, true );  testLong( (long)binCount, 0 );
+    unmapArray(mappedChars);
+    // Wrong type, or not an array file at all:
+    float const savedFloats[] = { 1.5f, -2.5f };
+    saveArrayF(binPath, savedFloats, 2);
+    errno = 0;
+    testBool( mapArrayI(binPath, &binCount) == NULL, true );  testInt( errno, EINVAL );  // (same size as float, though)
+    testBool( mapArrayLf(binPath, &binCount) == NULL, true );  testInt( errno, EINVAL );
+    truncate(binPath, 64 + sizeof(float));
+    testBool( mapArrayF(binPath, &binCount) == NULL, true );  testInt( errno, EINVAL );
+    writeTestFile(binPath, "3.5, 4.5");
+    testBool( mapArrayF(binPath, &binCount) == NULL, true );  testInt( errno, EINVAL );
+    unlink(binPath);
+    testBool( mapArrayF(binPath, &binCount) == NULL, true );  testInt( errno, ENOENT );
+    testLong( saveArrayF("/nonexistent-dir/x", savedFloats, 2), -1 );  testInt( errno, ENOENT );
+    unmapArray(NULL);
+
+    printTestMsg("\nTesting spawnProcess: ");
+    char spawnOutPath[] = "/tmp/ibarland-utils-test-XXXXXX";
+    char spawnInPath[]  = "/tmp/ibarland-utils-test-XXXXXX";
+    close( mkstemp(spawnOutPath) );
+    close( mkstemp(spawnInPath) );
+    char spawnOut[100];
+    pid_t child;
+    spawnOptions spawnOpts;
+    spawnOptions_init(&spawnOpts);
+    // args, and stdout/stderr to a file:
+    stringConst echoArgs[] = { "sh", "-c", "echo out:$0:$1; echo err >&2; exit 3", "a b", "c", NULL };
+    spawnOpts.redirect[1].path = spawnOutPath;
+    spawnOpts.redirect[2].path = spawnOutPath;
+    spawnOpts.redirect[2].append = true;
+    testInt( spawnProcess(&child, "/bin/sh", echoArgs, NULL, &spawnOpts), 0 );
+    testInt( waitForExit(child), 3 );
+    testStr( readTestFile(spawnOutPath, spawnOut, sizeof(spawnOut)), "out:a b:c\nerr\n" );
+    // stdin from a file, an environment of our own, and searching $PATH:
+    writeTestFile(spawnInPath, "42\n");
+    spawnOptions_init(&spawnOpts);
+    spawnOpts.redirect[0].path = spawnInPath;
+    spawnOpts.redirect[1].path = spawnOutPath;
+    spawnOpts.searchPath = true;
+    stringConst readArgs[] = { "sh", "-c", "read x; echo $x$GREETING", NULL };
+    stringConst env[] = { "GREETING=hi", "PATH=/bin:/usr/bin", NULL };
+    testInt( spawnProcess(&child, "sh", readArgs, env, &spawnOpts), 0 );
+    testInt( waitForExit(child), 0 );
+    testStr( readTestFile(spawnOutPath, spawnOut, sizeof(spawnOut)), "42hi\n" );
+    // stdout to a pipe:
+    int pipeFds[2];
+    testInt( pipe(pipeFds), 0 );
+    spawnOptions_init(&spawnOpts);
+    spawnOpts.redirect[1].fd = pipeFds[1];
+    stringConst pipeArgs[] = { "echo", "piped", NULL };
+    testInt( spawnProcess(&child, "/bin/echo", pipeArgs, NULL, &spawnOpts), 0 );
+    close(pipeFds[1]);
+    ssize_t const nPiped = read(pipeFds[0], spawnOut, sizeof(spawnOut)-1);
+    spawnOut[MAX(nPiped, 0)] = '\0';
+    close(pipeFds[0]);
+    testInt( waitForExit(child), 0 );
+    testStr( spawnOut, "piped\n" );
+    // Failures are returned, not exited on:
+    testInt( spawnProcess(&child, "/no/such/command", NULL, NULL, NULL), ENOENT );
+    spawnOptions_init(&spawnOpts);
+    spawnOpts.searchPath = true;
+    testInt( spawnProcess(&child, "no-such-command-anywhere", NULL, NULL, &spawnOpts), ENOENT );
+    spawnOpts.redirect[0].path = "/no/such/input";
+    testInt( spawnProcess(&child, "/bin/true", NULL, NULL, &spawnOpts), ENOENT );
+    testInt( spawnProcess(&child, "/bin/true", NULL, NULL, NULL), 0 );  // (and argv NULL is fine)
+    testInt( waitForExit(child), 0 );
+    unlink(spawnOutPath);
+    unlink(spawnInPath);
+
+    printTestMsg("\nTesting vecX: ");
+    vecI vi;
+    vecI_init(&vi);
+    testInt( (int)vi.len, 0 );
+    testBool( vi.data == vi.small, true );
+    char* viEmptyStr = vecI_toString(&vi, NULL, NULL, NULL, NULL);
+    testStr( viEmptyStr, "[]" );
+    free(viEmptyStr);
+    for (int k=0;  k<(int)VEC_SMALL_CAP(int);  ++k) { vecI_push(&vi, k); }
+    testBool( vi.data == vi.small, true );  // no malloc, yet
+    vecI_push(&vi, 8);
+    testBool( vi.data != vi.small, true );
+    testInt( (int)vi.len, (int)VEC_SMALL_CAP(int) + 1 );
+    testInt( vi.data[3], 3 );
+    testInt( vi.data[vi.len-1], 8 );
+    for (int k=9;  k<1000;  ++k) { vecI_push(&vi, k); }
+    testBool( vi.cap >= 1000 && vi.cap < 2*1000, true );
+    bool vecAllThere = true;
+    for (int k=0;  k<1000;  ++k) { vecAllThere = vecAllThere && vi.data[k] == k; }
+    testBool( vecAllThere, true );
+    testInt( vecI_pop(&vi), 999 );
+    testInt( (int)vi.len, 999 );
+    vecI_erase(&vi, 5, 990);  // leaves 0..4, 995..998
+    testInt( (int)vi.len, 9 );
+    testInt( vi.data[5], 995 );
+    vecI_insert(&vi, 0, -1);
+    vecI_insert(&vi, 3, -3);
+    vecI_insert(&vi, vi.len, -99);
+    vecI_erase(&vi, vi.len, 0);
+    char* viStr = vecI_toString(&vi, NULL, NULL, NULL, NULL);
+    testStr( viStr, "[-1,0,1,-3,2,3,4,995,996,997,998,-99]" );
+    free(viStr);
+    vecI_erase(&vi, 1, vi.len-2);
+    vecI_shrink(&vi);
+    testBool( vi.data == vi.small, true );  // back to the small-buffer
+    testInt( vi.data[0], -1 );
+    testInt( vi.data[1], -99 );
+    vecI_reserve(&vi, 5000);
+    testBool( vi.cap >= 5002, true );
+    int* const viData = vi.data;
+    for (int k=0;  k<5000;  ++k) { vecI_push(&vi, k); }
+    testBool( vi.data == viData, true );  // reserve meant no moving
+    vecI_shrink(&vi);
+    testInt( (int)vi.cap, 5002 );
+    vecI_free(&vi);
+    testInt( (int)vi.len, 0 );
+    vecI_push(&vi, 7);  // still usable, after free.
+    testInt( vi.data[0], 7 );
+    vecI_free(&vi);
+    vecLf vd;
+    vecLf_init(&vd);
+    vecLf_push(&vd, 1.5);
+    vecLf_push(&vd, -2.0);
+    char* vdStr = vecLf_toString(&vd, "<", "%.1f", "; ", ">");
+    testStr( vdStr, "<1.5; -2.0>" );
+    free(vdStr);
+    vecLf_free(&vd);
+    vecPt vp;
+    vecPt_init(&vp);
+    testInt( (int)vp.cap, 1 );
+    for (int k=0;  k<100;  ++k) { vecPt_push(&vp, (point3){ k, 2*k, 3*k }); }
+    vecPt_insert(&vp, 50, (point3){ -1, -1, -1 });
+    testDouble( vp.data[51].z, 150 );
+    testDouble( vp.data[50].x, -1 );
+    testDouble( vecPt_pop(&vp).y, 198 );
+    vecPt_free(&vp);
+
+    printTestMsg("\nTesting arena: ");
+    arena ar;
+    arena_init(&ar, 1024);
+    char* arStr = newStrCat_arena( &ar, "abc", intToString_arena(&ar, -42) );
+    testStr( arStr, "abc-42" );
+    testStr( uintToString_arena(&ar, 4000000000U), "4000000000" );
+    testStr( longToString_arena(&ar, LONG_MIN), "-9223372036854775808" );
+    testStr( ulongToString_arena(&ar, ULONG_MAX), "18446744073709551615" );
+    testStr( newStrCat_arena(&ar, NULL, "x"), "x" );
+    testStr( newStrCat_arena(&ar, "", ""), "" );
+    testBool( newStrCat_arena(&ar, NULL, NULL) == NULL, true );
+    strBuilder arSb;
+    sb_init(&arSb);
+    testStr( sb_finish_arena(&arSb, &ar), "" );
+    sb_appendf(&arSb, "%d-%s", 7, "up");
+    testStr( sb_finish_arena(&arSb, &ar), "7-up" );
+    bool arAligned = true;
+    for (int k=0;  k<200;  ++k) {  // many chunks' worth
+        void* const small = arena_alloc(&ar, (size_t)(k % 13) + 1);
+        double* const ds = ARENA_ALLOC_ARRAY(&ar, 3, double);
+        char* const big = arena_allocAligned(&ar, 100, 64);
+        arAligned = arAligned && (uintptr_t)small % ARENA_ALIGNMENT == 0
+                              && (uintptr_t)ds % _Alignof(double) == 0
+                              && (uintptr_t)big % 64 == 0;
+        memset(big, k, 100);
+        }
+    testBool( arAligned, true );
+    testStr( arStr, "abc-42" );  // (earlier allocations untouched)
+    int* arInts = newArrayI_arena(&ar, 10, 7);
+    testInt( arInts[9], 7 );
+    double* arHuge = newArrayLf_arena(&ar, 10000, 1.5);  // bigger than a chunk
+    testDouble( arHuge[9999], 1.5 );
+    arenaMark const arMark = arena_mark(&ar);
+    char* const arAfterMark = (char*) arena_alloc(&ar, 3000);
+    arAfterMark[2999] = 'x';
+    newArrayLf_uninit_arena(&ar, 5000);
+    arena_rewind(&ar, arMark);
+    testBool( arena_alloc(&ar, 3000) == arAfterMark, true );  // rewinding reclaimed it
+    testInt( arInts[9], 7 );
+    arena_reset(&ar);
+    char* const arFirst = (char*) arena_alloc(&ar, 1);
+    testBool( arFirst == arStr || arFirst < arStr, true );  // back to the start of the first chunk
+    for (int k=0;  k<200;  ++k) { arena_alloc(&ar, 100); }  // re-uses the spare chunks
+    arena_free(&ar);
+    testBool( ar.first == NULL, true );
+
+    printTestMsg("\nTesting strHash, hash maps: ");
+    testBool( strHash("hello") == strnHash("hello, world", 5), true );
+    testBool( strHash("hello") != strHash("hellp"), true );
+    testBool( strnHash("", 0) != strnHash("\0", 1), true );  // (the length counts)
+    testBool( strnHash("abcdefgh1", 9) != strnHash("abcdefgh2", 9), true );  // (the tail counts)
+    testBool( ulongHash(1) != ulongHash(2), true );
+    strIntMap sim;
+    strIntMap_init(&sim);
+    testBool( strIntMap_get(&sim, "absent") == NULL, true );
+    testBool( strIntMap_remove(&sim, "absent"), false );
+    testBool( strIntMap_put(&sim, "one", 1), true );
+    testBool( strIntMap_put(&sim, "two", 2), true );
+    testBool( strIntMap_put(&sim, "one", 11), false );  // replaced
+    testInt( (int)sim.len, 2 );
+    testInt( *strIntMap_get(&sim, "one"), 11 );
+    char oneAgain[] = "one";  // (a different pointer, same string)
+    testInt( *strIntMap_get(&sim, oneAgain), 11 );
+    testBool( strIntMap_remove(&sim, "one"), true );
+    testBool( strIntMap_get(&sim, "one") == NULL, true );
+    testInt( *strIntMap_get(&sim, "two"), 2 );
+    strIntMap_free(&sim);
+    // Many random operations, checked against a plain array:
+    #define MAP_KEYS 5000
+    long* mapShadow = newArrayLi( MAP_KEYS, -1 );  // -1: absent
+    ulongMap um;
+    ulongMap_init(&um);
+    collideMap cm;
+    collideMap_init(&cm);
+    rngState mapRng;
+    rng_seed(&mapRng, 77);
+    bool mapsAgree = true;
+    for (int step=0;  step<100000;  ++step) {
+        ulong const k = rng_below(&mapRng, MAP_KEYS);
+        uint const op = rng_below(&mapRng, 3);
+        if (op == 0) {
+            bool const wasNew = (mapShadow[k] == -1);
+            mapsAgree = mapsAgree && ulongMap_put(&um, k*7919, step) == wasNew;
+            if (step < 20000) collideMap_put(&cm, k, step);
+            mapShadow[k] = step;
+            }
+        else if (op == 1) {
+            mapsAgree = mapsAgree && ulongMap_remove(&um, k*7919) == (mapShadow[k] != -1);
+            if (step < 20000) collideMap_remove(&cm, k);
+            mapShadow[k] = -1;
+            }
+        else {
+            long* const v = ulongMap_get(&um, k*7919);
+            mapsAgree = mapsAgree && (v == NULL ? -1 : *v) == mapShadow[k];
+            }
+        if (step == 19999) {
+            for (ulong j=0;  j<MAP_KEYS;  ++j) {
+                long* const v = collideMap_get(&cm, j);
+                mapsAgree = mapsAgree && (v == NULL ? -1 : *v) == mapShadow[j];
+                }
+            }
+        }
+    testBool( mapsAgree, true );
+    size_t shadowLen = 0, mapEntries = 0;
+    for (ulong j=0;  j<MAP_KEYS;  ++j) { shadowLen += (mapShadow[j] != -1); }
+    for (size_t i=0;  i<um.cap;  ++i) { mapEntries += (um.hashes[i] != 0); }
+    testLong( (long)um.len, (long)shadowLen );
+    testLong( (long)mapEntries, (long)shadowLen );
+    testBool( um.len <= um.cap - um.cap/8, true );
+    ulongMap_reserve(&um, 100000);
+    testBool( um.cap >= 100000, true );
+    for (ulong j=0;  j<MAP_KEYS;  ++j) {  // (all still there, after re-hashing)
+        long* const v = ulongMap_get(&um, j*7919);
+        mapsAgree = mapsAgree && (v == NULL ? -1 : *v) == mapShadow[j];
+        }
+    testBool( mapsAgree, true );
+    ulongMap_free(&um);
+    collideMap_free(&cm);
+    free(mapShadow);
+
+    printTestMsg("\nTesting intern: ");
+    char internBuf[] = "hello";  // (not the same pointer as the literal)
+    stringConst hello1 = intern("hello");
+    stringConst hello2 = intern(internBuf);
+    testBool( streq_interned(hello1, hello2), true );
+    testStr( hello1, "hello" );
+    testBool( hello1 != internBuf, true );  // a copy
+    internBuf[0] = 'j';
+    testStr( hello1, "hello" );
+    testBool( intern_lookup("jello") == NULL, true );
+    testBool( intern_lookup("hello") == hello1, true );
+    testBool( streq_interned(intern("jello"), hello1), false );
+    testBool( intern_lookup(internBuf) == intern("jello"), true );
+    testBool( internn("hello, world", 5) == hello1, true );
+    testBool( intern("") == intern(""), true );
+    arena internArena;
+    arena_init(&internArena, 0);
+    internTable* localInterns = internTable_new(&internArena);
+    stringConst localHello = internTable_intern(localInterns, "hello");
+    testBool( localHello != hello1, true );  // a separate table
+    testBool( internTable_lookupn(localInterns, "hello!", 5) == localHello, true );
+    internTable_free(localInterns);
+    arena_free(&internArena);
+    sharedInterns = internTable_new(NULL);
+    const char* *internResults[4];
+    pthread_t internThreads[4];
+    for (int t=0;  t<4;  ++t) {
+        internResults[t] = (const char* *) malloc( INTERN_TEST_STRINGS * sizeof(const char*) );
+        pthread_create( &internThreads[t], NULL, internTestWorker, (void*)internResults[t] );
+        }
+    for (int t=0;  t<4;  ++t) { pthread_join( internThreads[t], NULL ); }
+    bool internsAgree = true;
+    char internExpect[32];
+    for (int k=0;  k<INTERN_TEST_STRINGS;  ++k) {
+        sprintf(internExpect, "identifier_%d", k);
+        for (int t=0;  t<4;  ++t) { internsAgree = internsAgree && internResults[t][k] == internResults[0][k]; }
+        internsAgree = internsAgree && streq(internResults[0][k], internExpect)
+                                    && internTable_lookup(sharedInterns, internExpect) == internResults[0][k];
+        }
+    testBool( internsAgree, true );
+    testLong( (long)internTable_count(sharedInterns), INTERN_TEST_STRINGS );
+    for (int t=0;  t<4;  ++t) { free(internResults[t]); }
+    internTable_free(sharedInterns);
+
+    printTestMsg("\nTesting pool: ");
+    pool pp;
+    pool_init(&pp, 3, 1);
+    testBool( pp.objSize >= 2*sizeof(void*), true );
+    char* pp1 = pool_alloc(&pp);
+    char* pp2 = pool_alloc(&pp);
+    testBool( pp1 != pp2, true );
+    pool_free(&pp, pp1);
+    testBool( pool_alloc(&pp) == pp1, true );  // most-recently-freed first
+    pool_free(&pp, NULL);
+    poolStats ppStats = pool_stats(&pp);
+    testLong( (long)ppStats.allocs, 3 );
+    testLong( (long)ppStats.cacheHits, 2 );  // all but the very first
+    testLong( (long)ppStats.frees, 1 );
+    testLong( (long)ppStats.slabs, 1 );
+    char* ppMany[1000];
+    for (int k=0;  k<1000;  ++k) { ppMany[k] = pool_alloc(&pp);  memset(ppMany[k], k, 3); }
+    bool ppIntact = true;
+    for (int k=0;  k<1000;  ++k) { ppIntact = ppIntact && ppMany[k][2] == (char)k; }
+    testBool( ppIntact, true );
+    for (int k=0;  k<1000;  ++k) { pool_free(&pp, ppMany[k]); }
+    ppStats = pool_stats(&pp);
+    testLong( (long)ppStats.frees, 1001 );
+    testBool( ppStats.flushes > 0, true );  // returned to the pool in batches
+    pool_destroy(&pp);
+    pool ppAligned;
+    pool_init(&ppAligned, 40, 64);
+    bool ppIsAligned = true;
+    for (int k=0;  k<100;  ++k) { ppIsAligned = ppIsAligned && (uintptr_t)pool_alloc(&ppAligned) % 64 == 0; }
+    testBool( ppIsAligned, true );
+    pool_destroy(&ppAligned);
+    pthread_t poolThreads[4];
+    for (long t=0;  t<4;  ++t) { pthread_create( &poolThreads[t], NULL, poolTestWorker, (void*)(intptr_t)(t+1) ); }
+    bool poolThreadsOk = true;
+    for (long t=0;  t<4;  ++t) {
+        void* rslt;
+        pthread_join( poolThreads[t], &rslt );
+        poolThreadsOk = poolThreadsOk && rslt == (void*)(intptr_t)(t+1);
+        }
+    testBool( poolThreadsOk, true );
+    poolStats const nodeStats = pool_stats(&pool_listNode);  // (each exiting thread gave back its cache and counts)
+    testLong( (long)nodeStats.allocs, 4*3*POOL_TEST_NODES );
+    testLong( (long)nodeStats.frees, 4*3*POOL_TEST_NODES );
+    testBool( nodeStats.cacheHits > nodeStats.allocs / 2, true );
+    if (print_on_test_success) printPoolStats( stdout, "\n  pool_listNode", nodeStats );
+
     printTestMsg("\nTesting swap: ");
     int i=5;
     int j=7;
@@ -8,7 +8,17 @@
 #include <stdio.h>
 #include <assert.h>
 #include <string.h> // for strcmp
+#include <ctype.h>  // for isspace
+#include <stdarg.h> // for sb_appendf
 #include <sys/time.h>
+#include <time.h>  // for clock_gettime
+#include <stdatomic.h>
+#include <stdint.h> // for uintptr_t
+#include <pthread.h>
+#include <fcntl.h>     // for open
+#include <sys/stat.h>  // for fstat
+#include <sys/mman.h>  // for mmap
+#include <spawn.h>     // for posix_spawn
 #include "ibarland-utils.h"
 
 // string-equal and string-different -- using `strcmp` in boolean expressions goofs me up otherwise.
@@ -17,50 +27,242 @@ bool strdiff( const char* const s1, const char* const s2 ) { return !streq(s1,s2
 // Note that we use the name 'strdiff' rather than 'strneq', since that's ambiguous with 'streq up to n chars'.
 bool strempty( const char* const s ) { return streq(s,""); }
 
+
+/* Hashing:  each 8 bytes is multiplied in (murmur-style), then the total gets murmur3's final avalanche. */
+#define HASH_K1 0x87C37B91114253D5UL
+#define HASH_K2 0x4CF5AD432745937FUL
+static inline ulong hashFinish( ulong h ) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDUL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53UL;
+    h ^= h >> 33;
+    return h;
+    }
+static inline ulong hashWord( ulong h, ulong w ) {
+    w *= HASH_K1;
+    w = (w << 31) | (w >> 33);
+    w *= HASH_K2;
+    h ^= w;
+    return ((h << 27) | (h >> 37)) * 5 + 0x52DCE729;
+    }
+
+ulong strnHash( const char* s, size_t len ) {
+    ulong h = len * HASH_K2;
+    size_t i = 0;
+    for (;  i+8 <= len;  i += 8) {
+        ulong w;
+        memcpy(&w, s+i, 8);
+        h = hashWord(h, w);
+        }
+    if (i < len) {
+        ulong w = 0;
+        memcpy(&w, s+i, len-i);
+        h = hashWord(h, w);
+        }
+    return hashFinish(h);
+    }
+ulong strHash( stringConst s ) { return strnHash(s, strlen(s)); }
+ulong ulongHash( ulong n ) { return hashFinish(n + HASH_K1); }
+
+static void sb_vappendf( strBuilder* sb, stringConst fmt, va_list args );
+
 // A flag for whether successful test-cases should print a very-short indicator.
 bool print_on_test_success = true;
 
-int testCount = 0;
-int testFailCount = 0;
+/* Test-counting:
+ * The totals are atomic (each on its own cache-line, so that worker threads bumping them don't
+ * fight over one line); a test case running via runTestCases also keeps its own counts and output,
+ * in a testCaseState that only its worker thread touches.
+ */
+typedef struct {
+    _Alignas(64) atomic_int value;
+    char padding[64 - sizeof(atomic_int)];
+    } paddedCounter;
+
+static paddedCounter testCount = { 0 };
+static paddedCounter testFailCount = { 0 };
 const int TEST_INDICATOR_GROUP_SIZE = 5;
 
+typedef struct {
+    const char* name;
+    testCaseFunc func;
+    strBuilder output;
+    int count;
+    int failCount;
+    ulong nsec;
+    } testCaseState;
+
+static _Thread_local testCaseState* currentTestCase = NULL;  // NULL when not inside runTestCases.
+
+int testsRun()    { return atomic_load(&testCount.value); }
+int testsFailed() { return atomic_load(&testFailCount.value); }
+
 void resetTestSummary() {
-    testCount = 0;
-    testFailCount = 0;
+    atomic_store(&testCount.value, 0);
+    atomic_store(&testFailCount.value, 0);
     printTestMsg("\n");
     }
 
+/* Print to stdout -- or if we're inside a test case, to that case's buffer (printed when the case finishes). */
+void testMsg( stringConst fmt, ... ) {
+    va_list args;
+    va_start(args, fmt);
+    if (currentTestCase == NULL) {
+        vprintf(fmt, args);
+        }
+    else {
+        sb_vappendf(&currentTestCase->output, fmt, args);
+        }
+    va_end(args);
+    }
+
+/* Count one more test; return how many this case (or if not in a case, the whole run) has seen. */
+static int countTest() {
+    int const total = atomic_fetch_add(&testCount.value, 1) + 1;
+    if (currentTestCase == NULL) return total;
+    return ++currentTestCase->count;
+    }
+
+static void countFailure() {
+    atomic_fetch_add(&testFailCount.value, 1);
+    if (currentTestCase != NULL) ++currentTestCase->failCount;
+    }
+
 
 stringConst FAIL_HEADER = "\n***TEST FAILED***\n";
 
 
-void printTestSuccess() {
+void printTestSuccess( int const countSoFar ) {
     if (print_on_test_success) printTestMsg(".");
-    if (testCount % TEST_INDICATOR_GROUP_SIZE == 0) printTestMsg(" ");
+    if (countSoFar % TEST_INDICATOR_GROUP_SIZE == 0) printTestMsg(" ");
     }
 
 #define printTestFailure( act, exp, typeFormat, surrounder ) \
-    ++testFailCount; \
+    countFailure(); \
     printTestMsg( "%s" "actual: " surrounder typeFormat surrounder "\nexpect: " surrounder typeFormat surrounder "\n", FAIL_HEADER, act, exp )
     // Use a macro so that we don't have to repeat for each type.
 
 void printTestSummary() {
+    int const count = testsRun();
+    int const failCount = testsFailed();
     printTestMsg( "\n" );
     printTestMsg( "vvvvvvvvvvvvvvvvvvv\n" );
-    printTestMsg( "%5d tests run.\n", testCount );
-    if (testFailCount==0) { printTestMsg( "      All passed!\n" ); }
-    else { printTestMsg( "%5d tests passed;\n%5d tests FAILED (%f%%)\n", testCount-testFailCount, testFailCount, (100.0*testFailCount/testCount) ); }
+    printTestMsg( "%5d tests run.\n", count );
+    if (failCount==0) { printTestMsg( "      All passed!\n" ); }
+    else { printTestMsg( "%5d tests passed;\n%5d tests FAILED (%f%%)\n", count-failCount, failCount, (100.0*failCount/count) ); }
     printTestMsg( "^^^^^^^^^^^^^^^^^^^\n" );
     }
 
+
+/* Registered test cases, and the machinery for running them in parallel:
+ * workers claim the next case by bumping an atomic index, run it with its output going to its own buffer,
+ * and mark it done; meanwhile the calling thread prints each case's output in registration order,
+ * waiting for each in turn.
+ */
+static testCaseState* testCases = NULL;
+static int testCaseCount = 0;
+static int testCaseCap = 0;
+
+void registerTestCase( stringConst name, testCaseFunc func ) {
+    if (testCaseCount == testCaseCap) {
+        testCaseCap = MAX(2*testCaseCap, 16);
+        testCases = (testCaseState*) realloc( testCases, (size_t)testCaseCap * sizeof(testCaseState) );
+        assert(testCases != NULL);
+        }
+    testCaseState* const c = &testCases[testCaseCount++];
+    c->name = name;
+    c->func = func;
+    }
+
+typedef struct {
+    testCaseState** toRun;
+    int numToRun;
+    atomic_int nextToClaim;
+    bool* done;             // guarded by `lock`
+    pthread_mutex_t lock;
+    pthread_cond_t  finished;
+    } testRun;
+
+static void* testWorker( void* arg ) {
+    testRun* const run = (testRun*) arg;
+    int i;
+    while ((i = atomic_fetch_add(&run->nextToClaim, 1)) < run->numToRun) {
+        testCaseState* const c = run->toRun[i];
+        currentTestCase = c;
+        ulong const start = time_nsec();
+        c->func();
+        c->nsec = time_nsec() - start;
+        currentTestCase = NULL;
+        pthread_mutex_lock(&run->lock);
+        run->done[i] = true;
+        pthread_cond_broadcast(&run->finished);
+        pthread_mutex_unlock(&run->lock);
+        }
+    return NULL;
+    }
+
+int runTestCases( uint numWorkers, stringConst filter ) {
+    if (numWorkers == 0) {
+        long const cores = sysconf(_SC_NPROCESSORS_ONLN);
+        numWorkers = (cores > 0)  ?  (uint)cores  :  1u;
+        }
+    testRun run;
+    run.toRun = (testCaseState**) malloc( (size_t)MAX(testCaseCount,1) * sizeof(testCaseState*) );
+    run.done = ALLOC_ARRAY( MAX(testCaseCount,1), bool );
+    assert(run.toRun != NULL && run.done != NULL);
+    run.numToRun = 0;
+    for (int i=0;  i<testCaseCount;  ++i) {
+        if (filter != NULL && strstr(testCases[i].name, filter) == NULL) continue;
+        testCaseState* const c = &testCases[i];
+        sb_init(&c->output);
+        c->count = 0;
+        c->failCount = 0;
+        c->nsec = 0;
+        run.toRun[run.numToRun++] = c;
+        }
+    atomic_init(&run.nextToClaim, 0);
+    pthread_mutex_init(&run.lock, NULL);
+    pthread_cond_init(&run.finished, NULL);
+
+    numWorkers = MIN(numWorkers, (uint)MAX(run.numToRun,1));
+    pthread_t* workers = ALLOC_ARRAY(numWorkers, pthread_t);
+    for (uint w=0;  w<numWorkers;  ++w) {
+        int const err = pthread_create(&workers[w], NULL, testWorker, &run);
+        assert(err == 0);
+        }
+
+    int casesFailed = 0;
+    for (int i=0;  i<run.numToRun;  ++i) {
+        pthread_mutex_lock(&run.lock);
+        while (!run.done[i]) pthread_cond_wait(&run.finished, &run.lock);
+        pthread_mutex_unlock(&run.lock);
+        testCaseState* const c = run.toRun[i];
+        printf("\n%s: ", c->name);
+        if (c->output.str != NULL) fputs(c->output.str, stdout);
+        printf("  [%d tests%s, %.3fms]", c->count, (c->failCount > 0 ? ", SOME FAILED" : ""), (double)c->nsec / 1e6);
+        if (c->failCount > 0) ++casesFailed;
+        sb_free(&c->output);
+        }
+    printf("\n");
+
+    for (uint w=0;  w<numWorkers;  ++w) { pthread_join(workers[w], NULL); }
+    pthread_mutex_destroy(&run.lock);
+    pthread_cond_destroy(&run.finished);
+    free(workers);
+    free(run.done);
+    free(run.toRun);
+    return casesFailed;
+    }
+
 /* Are two strings the same (or, both null)?
  * If not, print an error message;
  * if so, and print_on_test_success, print a very-short indicator.
  */
 void testStr( stringConst actual, stringConst expected ) {
-    ++testCount;
+    int const countSoFar = countTest();
     if (actual==expected || (actual != NULL && expected != NULL && streq(actual,expected))) {
-        printTestSuccess();
+        printTestSuccess(countSoFar);
         }
     else { printTestFailure(actual, expected, "%s", "\""); }
     }
@@ -70,8 +272,8 @@ void testStr( stringConst actual, stringConst expected ) {
  * if so, and print_on_test_success, print a very-short indicator.
  */
 void testChar( char const actual, char const expected ) {
-    ++testCount;
-    if (actual==expected) { printTestSuccess(); }
+    int const countSoFar = countTest();
+    if (actual==expected) { printTestSuccess(countSoFar); }
     else { printTestFailure(actual, expected, "%c", "'"); }
     }
 
@@ -80,19 +282,48 @@ void testChar( char const actual, char const expected ) {
  * if so, and print_on_test_success, print a very-short indicator.
  */
 void testDouble( double const actual, double const expected ) {
-    ++testCount;
-    if (approxEquals(actual,expected) || (isnan(actual) && isnan(expected))) { printTestSuccess(); }
+    int const countSoFar = countTest();
+    if (approxEquals(actual,expected) || (isnan(actual) && isnan(expected))) { printTestSuccess(countSoFar); }
     else { printTestFailure(actual, expected, "%lf", ""); }
     }
 
 
+/* Are two arrays of doubles (or floats) the same, element-by-element (as testDouble)?
+ * This counts as a single test.  On failure, print only the first few mismatches, and how many there were in all.
+ */
+#define TEST_ARRAY_MISMATCHES_SHOWN 5
+
+#define MAKE_TEST_FLOATING_ARRAY_FUNC_BODY(typ, approxEqualsArrX) \
+( const typ* actual, const typ* expected, ulong sz ) { \
+    int const countSoFar = countTest(); \
+    arrMismatches const found = approxEqualsArrX( actual, expected, sz, 0.00001, 1e-9 ); \
+    ulong failures = 0; \
+    /* Recheck the (hopefully few) mismatches, since here -- as in testDouble -- NaN passes for NaN. */ \
+    for (ulong i = (found.count == 0 ? sz : (ulong)found.first);  i < sz;  ++i) { \
+        if (approxEqualsRel(actual[i], expected[i], 0.00001, 1e-9) || (isnan(actual[i]) && isnan(expected[i]))) continue; \
+        if (failures == 0) { countFailure();  printTestMsg( "%s", FAIL_HEADER ); } \
+        if (failures < TEST_ARRAY_MISMATCHES_SHOWN) { \
+            printTestMsg( "[%lu]  actual: %lf  expect: %lf\n", i, (double)actual[i], (double)expected[i] ); \
+            } \
+        ++failures; \
+        } \
+    if (failures > TEST_ARRAY_MISMATCHES_SHOWN) { \
+        printTestMsg( "...and %lu more (%lu of %lu elements differ).\n", failures - TEST_ARRAY_MISMATCHES_SHOWN, failures, sz ); \
+        } \
+    if (failures == 0) printTestSuccess(countSoFar); \
+    }
+
+void testDoubleArray MAKE_TEST_FLOATING_ARRAY_FUNC_BODY(double, approxEqualsArrD)
+void testFloatArray  MAKE_TEST_FLOATING_ARRAY_FUNC_BODY(float,  approxEqualsArrF)
+
+
 /* Are two ints the same?
  * If not, print an error message;
  * if so, and print_on_test_success, print a very-short indicator.
  */
 void testInt( int const actual, int const expected ) {
-    ++testCount;
-    if (actual==expected) { printTestSuccess(); }
+    int const countSoFar = countTest();
+    if (actual==expected) { printTestSuccess(countSoFar); }
     else { printTestFailure(actual, expected, "%i", ""); }
     }
 
@@ -101,8 +332,8 @@ void testInt( int const actual, int const expected ) {
  * if so, and print_on_test_success, print a very-short indicator.
  */
 void testUInt( uint const actual, uint const expected ) {
-    ++testCount;
-    if (actual==expected) { printTestSuccess(); }
+    int const countSoFar = countTest();
+    if (actual==expected) { printTestSuccess(countSoFar); }
     else { printTestFailure(actual, expected, "%u", ""); }
     }
 
@@ -112,8 +343,8 @@ void testUInt( uint const actual, uint const expected ) {
  * if so, and print_on_test_success, print a very-short indicator.
  */
 void testLong( long const actual, long const expected ) {
-    ++testCount;
-    if (actual==expected) { printTestSuccess(); }
+    int const countSoFar = countTest();
+    if (actual==expected) { printTestSuccess(countSoFar); }
     else { printTestFailure(actual, expected, "%li", ""); }
     }
 
@@ -122,12 +353,189 @@ void testLong( long const actual, long const expected ) {
  * if so, and print_on_test_success, print a very-short indicator.
  */
 void testBool( bool const actual, bool const expected ) {
-    ++testCount;
-    if (actual==expected) { printTestSuccess(); }
+    int const countSoFar = countTest();
+    if (actual==expected) { printTestSuccess(countSoFar); }
     else { printTestFailure(actual, expected, "%i", ""); }
     }
 
 
+/* Micro-benchmarks:
+ * Registered benchmarks live in a growable array (filled in, typically, by BENCH's constructor functions
+ * before main even starts).  Running one means:  double the iteration-count until a single sample takes
+ * long enough to time reliably (which doubles as warm-up), keep warming up for a bit, then time a
+ * batch of samples and report the min/median/p99 of their per-op times.
+ */
+static benchCase* benchCases = NULL;
+static int benchCaseCount = 0;
+static int benchCaseCap = 0;
+
+uint  bench_sampleCount     = 31;
+ulong bench_sampleNsec      = 2000000UL;    // aim for 2ms per sample
+ulong bench_warmupNsec      = 20000000UL;   // 20ms of warm-up per benchmark
+ulong bench_maxNsecPerBench = 2000000000UL; // but don't spend more than 2s on any one benchmark's samples
+
+void registerBench( stringConst name, benchFunc func, long arg ) {
+    if (benchCaseCount == benchCaseCap) {
+        benchCaseCap = MAX(2*benchCaseCap, 16);
+        benchCases = (benchCase*) realloc( benchCases, (size_t)benchCaseCap * sizeof(benchCase) );
+        assert(benchCases != NULL);
+        }
+    benchCase const c = { name, func, arg };
+    benchCases[benchCaseCount++] = c;
+    }
+
+const benchCase* registeredBenches( int* count ) {
+    *count = benchCaseCount;
+    return benchCases;
+    }
+
+static ulong timeBenchSample( const benchCase* c, ulong const iters ) {
+    ulong const start = time_nsec();
+    c->func(iters, c->arg);
+    return time_nsec() - start;
+    }
+
+static int compareDoubles( const void* a, const void* b ) {
+    double const x = *(const double*)a,  y = *(const double*)b;
+    return (x > y) - (x < y);
+    }
+
+benchResult runBench( const benchCase* c ) {
+    // Calibrate (and warm up):  find an iteration-count whose sample takes at least bench_sampleNsec.
+    ulong iters = 1;
+    ulong elapsed = timeBenchSample(c, iters);
+    ulong warmedUp = elapsed;
+    while (elapsed < bench_sampleNsec) {
+        iters = (elapsed == 0)  ?  iters*2  :  MAX(iters*2, MIN(iters*100, iters*bench_sampleNsec/elapsed + 1));
+        elapsed = timeBenchSample(c, iters);
+        warmedUp += elapsed;
+        }
+    while (warmedUp < bench_warmupNsec) { warmedUp += timeBenchSample(c, iters); }
+
+    uint const affordable = (uint) MIN( (ulong)bench_sampleCount, MAX(bench_maxNsecPerBench / MAX(elapsed,1UL), 5UL) );
+    double* perOp = (double*) malloc( affordable * sizeof(double) );
+    assert(perOp != NULL);
+    for (uint i=0;  i<affordable;  ++i) {
+        perOp[i] = (double)timeBenchSample(c, iters) / (double)iters;
+        }
+    qsort(perOp, affordable, sizeof(double), compareDoubles);
+    benchResult const r = { newStrCat(c->name, ""), iters, affordable,
+                            perOp[0], perOp[affordable/2], perOp[(affordable*99 - 1)/100] };
+    free(perOp);
+    return r;
+    }
+
+void printBenchResult( FILE* f, benchResult const r ) {
+    fprintf(f, "%-40s %12.2f ns/op (min) %12.2f (median) %12.2f (p99)   [%u samples x %lu iters]\n",
+            r.name, r.minNsec, r.medianNsec, r.p99Nsec, r.samples, r.itersPerSample);
+    }
+
+/* JSON strings need `"` and `\` escaped (and control-chars, which we just drop). */
+static void printJsonString( FILE* f, stringConst s ) {
+    fputc('"', f);
+    for (const char* p = s;  *p != '\0';  ++p) {
+        if (*p == '"' || *p == '\\') fputc('\\', f);
+        if ((uchar)*p >= ' ') fputc(*p, f);
+        }
+    fputc('"', f);
+    }
+
+void printBenchResults_json( FILE* f, const benchResult* results, int const n ) {
+    fprintf(f, "{\n  \"benchmarks\": [");
+    for (int i=0;  i<n;  ++i) {
+        fprintf(f, "%s\n    { \"name\": ", (i==0 ? "" : ","));
+        printJsonString(f, results[i].name);
+        fprintf(f, ", \"min_ns\": %.3f, \"median_ns\": %.3f, \"p99_ns\": %.3f, \"samples\": %u, \"iters\": %lu }",
+                results[i].minNsec, results[i].medianNsec, results[i].p99Nsec, results[i].samples, results[i].itersPerSample);
+        }
+    fprintf(f, "\n  ]\n}\n");
+    }
+
+benchResult* runBenches( stringConst filter, FILE* progress, int* numRun ) {
+    benchResult* results = (benchResult*) malloc( (size_t)MAX(benchCaseCount,1) * sizeof(benchResult) );
+    assert(results != NULL);
+    int n = 0;
+    for (int i=0;  i<benchCaseCount;  ++i) {
+        if (filter != NULL && strstr(benchCases[i].name, filter) == NULL) continue;
+        results[n] = runBench(&benchCases[i]);
+        if (progress != NULL) { printBenchResult(progress, results[n]); fflush(progress); }
+        ++n;
+        }
+    *numRun = n;
+    return results;
+    }
+
+int runAllBenches( stringConst filter, bool const asJson, FILE* f ) {
+    int n;
+    benchResult* results = runBenches( filter, (asJson ? NULL : f), &n );
+    if (asJson) printBenchResults_json(f, results, n);
+    freeBenchResults(results, n);
+    return n;
+    }
+
+/* Register `name/size` for each of the sizes; the names are allocated once, and never freed. */
+void registerBenchSizes( stringConst name, benchFunc func, const long* sizes, int const numSizes ) {
+    for (int i=0;  i<numSizes;  ++i) {
+        strBuilder sb;
+        sb_init(&sb);
+        sb_appendf(&sb, "%s/%li", name, sizes[i]);
+        registerBench( sb_finish(&sb), func, sizes[i] );
+        }
+    }
+
+/* Read back what printBenchResults_json wrote:  one benchmark per line, fields in that order.
+ * (This is not a general JSON parser!)
+ */
+benchResult* readBenchResults_json( FILE* f, int* n ) {
+    int cap = 16;
+    benchResult* results = (benchResult*) malloc( (size_t)cap * sizeof(benchResult) );
+    assert(results != NULL);
+    *n = 0;
+    char line[1024];
+    char name[sizeof(line)];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        benchResult r;
+        if (sscanf(line, " { \"name\": \"%[^\"]\", \"min_ns\": %lf, \"median_ns\": %lf, \"p99_ns\": %lf, \"samples\": %u, \"iters\": %lu",
+                   name, &r.minNsec, &r.medianNsec, &r.p99Nsec, &r.samples, &r.itersPerSample) != 6) continue;
+        if (*n == cap) {
+            cap *= 2;
+            results = (benchResult*) realloc( results, (size_t)cap * sizeof(benchResult) );
+            assert(results != NULL);
+            }
+        r.name = newStrCat(name, "");
+        results[(*n)++] = r;
+        }
+    return results;
+    }
+
+void freeBenchResults( benchResult* results, int const n ) {
+    for (int i=0;  i<n;  ++i) { free(results[i].name); }
+    free(results);
+    }
+
+/* Match up benchmarks by name, and compare their medians. */
+int printBenchComparison( FILE* f, const benchResult* baseline, int const nBase,
+                          const benchResult* current, int const nCur, double const thresholdPct ) {
+    int regressions = 0;
+    fprintf(f, "%-40s %12s %12s %9s\n", "benchmark", "base(ns/op)", "now(ns/op)", "change");
+    for (int i=0;  i<nCur;  ++i) {
+        const benchResult* base = NULL;
+        for (int j=0;  j<nBase && base==NULL;  ++j) {
+            if (streq(baseline[j].name, current[i].name)) base = &baseline[j];
+            }
+        if (base == NULL) {
+            fprintf(f, "%-40s %12s %12.2f %9s\n", current[i].name, "-", current[i].medianNsec, "new");
+            continue;
+            }
+        double const pct = 100.0 * (current[i].medianNsec - base->medianNsec) / base->medianNsec;
+        stringConst verdict = (pct > thresholdPct)  ?  "  SLOWER"  :  ((pct < -thresholdPct)  ?  "  faster"  :  "");
+        if (pct > thresholdPct) ++regressions;
+        fprintf(f, "%-40s %12.2f %12.2f %+8.1f%%%s\n", current[i].name, base->medianNsec, current[i].medianNsec, pct, verdict);
+        }
+    return regressions;
+    }
+
+
 /* Return the #microseconds since the standard epoch. */
 ulong time_usec() {
   struct timeval now;
@@ -135,48 +543,199 @@ ulong time_usec() {
   return (ulong) (now.tv_sec*1000000L + now.tv_usec);
   }
 
-/* Return a string numeral, for the given int.
- * The string is heap-allocated; IT IS THE CALLER'S RESPONSIBILITY TO FREE THE STRING when done with it.
+/* Return the #nanoseconds on the monotonic clock (since some arbitrary starting point, like boot).
+ * Unlike time_usec, this never jumps backwards (e.g. when NTP adjusts the wall-clock),
+ * so the difference of two readings is a trustworthy elapsed-time.
  */
-char* intToString( int const n ) {
-  // We could just allocate enough space for 11-ish digits, which currently works, but only if sizeof(int) <= 4.
-  // We could allocate enough space based on sizeof(int):   ((int)ceil(8*sizeof(int) * log10(2))   digits
-  // But hey, we might as well allocate just the right amount:    ceil(log10(n))
-  int nSameDigits = (n==0)  ?  1  :  (abs(n) < 0  ?  abs(n+1)  :  abs(n)); // A version of n that has the same #digits.
-  uint numDigits = (uint)ceil( log10(nSameDigits+0.001) );  // hack: add epsilon so that n=1000 rounds up to 4, not 3; AND handle n=0.
-  char* nAsStr = (char*) malloc( (numDigits+1+1) * sizeof(char) ); // +1 for sign, +1 for terminating null.
-  sprintf( nAsStr, "%i", n );
-  return nAsStr;
+ulong time_nsec() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (ulong)now.tv_sec*1000000000UL + (ulong)now.tv_nsec;
   }
 
-/* Return a string numeral, for the given int.
- * The string is heap-allocated; IT IS THE CALLER'S RESPONSIBILITY TO FREE THE STRING when done with it.
+/* Like time_nsec, but cheaper and only as precise as the kernel's tick (typically 1-4ms). */
+ulong time_nsec_coarse() {
+#ifdef CLOCK_MONOTONIC_COARSE
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+  return (ulong)now.tv_sec*1000000000UL + (ulong)now.tv_nsec;
+#else
+  return time_nsec();
+#endif
+  }
+
+
+/* Cycle-counting:  On x86, read the time-stamp counter directly (a few ns, vs ~20ns for clock_gettime).
+ * Elsewhere, fall back to time_nsec (so one "cycle" is one ns).
  */
-char* uintToString( uint const n ) {
-  // We could just allocate enough space for 11-ish digits, which currently works, but only if sizeof(uint) <= 4.
-  // We could allocate enough space based on sizeof(int):   ((int)ceil(8*sizeof(int) * log10(2))   digits
-  // But hey, we might as well allocate just the right amount:    ceil(log10(n))
-  uint nSameDigits = (n==0)  ?  1  :  n; // A version of n that has the same #digits.
-  uint numDigits = (uint)ceil( log10(nSameDigits+0.001) );  // hack: add epsilon so that n=1000 rounds up to 4, not 3; AND handle n=0.
-  char* nAsStr = (char*) malloc( (numDigits+1) * sizeof(char) ); // +1 for terminating null.
-  sprintf( nAsStr, "%u", n );
-  return nAsStr;
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+ulong cycles_now() { return (ulong)__rdtsc(); }
+ulong cycles_now_ordered() { uint aux;  return (ulong)__rdtscp(&aux); }
+#else
+ulong cycles_now() { return time_nsec(); }
+ulong cycles_now_ordered() { return time_nsec(); }
+#endif
+
+static double cyclesPerNsec = 0.0;  // 0 means "not yet calibrated".
+
+/* Count cycles across a few ms of the monotonic clock. */
+double calibrateCycles() {
+  const ulong CALIBRATION_NSEC = 5000000UL;
+  ulong const nsecStart = time_nsec();
+  ulong const cyclesStart = cycles_now_ordered();
+  ulong nsecEnd;
+  do { nsecEnd = time_nsec(); } while (nsecEnd - nsecStart < CALIBRATION_NSEC);
+  ulong const cyclesEnd = cycles_now_ordered();
+  double const rate = (double)(cyclesEnd - cyclesStart) / (double)(nsecEnd - nsecStart);
+  __atomic_store(&cyclesPerNsec, &rate, __ATOMIC_RELAXED);
+  return rate;
+  }
+
+double cycles_perNsec() {
+  double rate;
+  __atomic_load(&cyclesPerNsec, &rate, __ATOMIC_RELAXED);
+  return (rate > 0.0)  ?  rate  :  calibrateCycles();
   }
 
+ulong cyclesToNsec( ulong const cycles ) { return (ulong)((double)cycles / cycles_perNsec()); }
 
-/* Return a string numeral, for the given long.
- * The string is heap-allocated; IT IS THE CALLER'S RESPONSIBILITY TO FREE THE STRING when done with it.
+/* Number-formatting:
+ * We count the digits with integer arithmetic (via count-leading-zeros),
+ * then write the digits right-to-left, two at a time, from a table of all 100 digit-pairs.
+ * No floating-point, no sprintf, and no allocation unless the caller wants a fresh string.
  */
-char* longToString( long const n ) {
-  // We could just allocate enough space for 20 digits, which currently works, but only if sizeof(long) <= 8.
-  // We could allocate enough space based on sizeof(long):   ((int)ceil(8*sizeof(long) * log10(2))   digits
-  // But hey, we might as well allocate just the right amount:    ceil(log10(n))
-  long nSameDigits = (n==0)  ?  1  :  (labs(n) < 0  ?  labs(n+1)  :  labs(n)); // A version of n that has the same #digits.
-  uint numDigits = (uint)ceil( log10(nSameDigits+0.001) );  // hack: add epsilon so that n=1000 rounds up to 4, not 3; AND handle n=0.
-  char* nAsStr = (char*) malloc( (numDigits+1+1) * sizeof(char) ); // +1 for sign, +1 for terminating null.
-  sprintf( nAsStr, "%ld", n );
-  return nAsStr;
+static const char DIGIT_PAIRS[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static const ulong POWERS_OF_10[20] = {
+  1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL,
+  10000000000UL, 100000000000UL, 1000000000000UL, 10000000000000UL, 100000000000000UL,
+  1000000000000000UL, 10000000000000000UL, 100000000000000000UL, 1000000000000000000UL,
+  10000000000000000000UL };
+
+/* The number of decimal digits in n (so, 1 for n==0).
+ * log10(n) is about log2(n) * 1233/4096; that guess is either right or one too small,
+ * and a single table-lookup tells us which.
+ */
+uint numDigits_ul( ulong const n ) {
+  uint const bits = 64u - (uint)__builtin_clzl(n|1);
+  uint const guess = (bits * 1233u) >> 12;
+  return guess + ((n|1) >= POWERS_OF_10[guess]);
+  }
+uint numDigits_u( uint const n ) {
+  uint const bits = 32u - (uint)__builtin_clz(n|1);
+  uint const guess = (bits * 1233u) >> 12;
+  return guess + ((n|1) >= POWERS_OF_10[guess]);
+  }
+
+/* Write the `len` digits of n, so that the last one lands at end[-1]. */
+static void writeDigits_ul( ulong n, char* const end ) {
+  char* p = end;
+  while (n >= 100) {
+    ulong const pairIdx = (n % 100) * 2;
+    n /= 100;
+    *--p = DIGIT_PAIRS[pairIdx+1];
+    *--p = DIGIT_PAIRS[pairIdx];
+    }
+  if (n >= 10) {
+    *--p = DIGIT_PAIRS[n*2+1];
+    *--p = DIGIT_PAIRS[n*2];
+    }
+  else {
+    *--p = (char)('0' + n);
+    }
+  }
+
+/* The work for all the ..._into functions:  write (optional) '-', then the digits of `magnitude`. */
+static size_t formatInto( ulong const magnitude, bool const isNeg, uint const nDigits, char* buf, size_t cap ) {
+  size_t const len = nDigits + (isNeg ? 1 : 0);
+  if (len+1 > cap) return len;
+  if (isNeg) buf[0] = '-';
+  writeDigits_ul( magnitude, buf+len );
+  buf[len] = '\0';
+  return len;
+  }
+
+// For negatives, negate in unsigned arithmetic, so that INT_MIN/LONG_MIN don't overflow.
+size_t intToString_into( int const n, char* buf, size_t cap ) {
+  uint const mag = (n < 0)  ?  0u - (uint)n  :  (uint)n;
+  return formatInto( mag, n < 0, numDigits_u(mag), buf, cap );
+  }
+size_t uintToString_into( uint const n, char* buf, size_t cap ) {
+  return formatInto( n, false, numDigits_u(n), buf, cap );
+  }
+size_t longToString_into( long const n, char* buf, size_t cap ) {
+  ulong const mag = (n < 0)  ?  0ul - (ulong)n  :  (ulong)n;
+  return formatInto( mag, n < 0, numDigits_ul(mag), buf, cap );
   }
+size_t ulongToString_into( ulong const n, char* buf, size_t cap ) {
+  return formatInto( n, false, numDigits_ul(n), buf, cap );
+  }
+
+/* The malloc'ing versions:  measure, allocate exactly, then format. */
+#define MAKE_TO_STRING_FUNC_BODY(typ,intoFunc)\
+( typ const n ) { \
+    size_t const len = intoFunc( n, NULL, 0 ); \
+    char* nAsStr = (char*) malloc( (len+1) * sizeof(char) ); /* +1 for terminating null. */ \
+    intoFunc( n, nAsStr, len+1 ); \
+    return nAsStr; \
+    }
+
+/* Return a string numeral, for the given int.
+ * The string is heap-allocated; IT IS THE CALLER'S RESPONSIBILITY TO FREE THE STRING when done with it.
+ */
+char* intToString   MAKE_TO_STRING_FUNC_BODY(int,intToString_into)
+char* uintToString  MAKE_TO_STRING_FUNC_BODY(uint,uintToString_into)
+char* longToString  MAKE_TO_STRING_FUNC_BODY(long,longToString_into)
+char* ulongToString MAKE_TO_STRING_FUNC_BODY(ulong,ulongToString_into)
+
+#define MAKE_TO_STRING_ARENA_FUNC_BODY(typ,intoFunc)\
+( arena* a, typ const n ) { \
+    char buf[INT_TO_STRING_MAX_LEN]; \
+    size_t const len = intoFunc( n, buf, sizeof(buf) ); \
+    char* nAsStr = (char*) arena_allocAligned( a, len+1, 1 ); \
+    memcpy( nAsStr, buf, len+1 ); \
+    return nAsStr; \
+    }
+char* intToString_arena   MAKE_TO_STRING_ARENA_FUNC_BODY(int,intToString_into)
+char* uintToString_arena  MAKE_TO_STRING_ARENA_FUNC_BODY(uint,uintToString_into)
+char* longToString_arena  MAKE_TO_STRING_ARENA_FUNC_BODY(long,longToString_into)
+char* ulongToString_arena MAKE_TO_STRING_ARENA_FUNC_BODY(ulong,ulongToString_into)
+
+
+/* Format each of arr[0..sz-1] as a numeral, all into one (exactly-sized) buffer;
+ * numeral #i is at buf+offsets[i], and offsets[sz] is the total size of buf.
+ * We make one pass just to count digits (cheap), so that we can allocate exactly once.
+ */
+#define MAKE_TO_NUMERALS_FUNC_BODY(typ,intoFunc)\
+( const typ* const arr, size_t const sz, size_t* offsets ) { \
+    size_t total = 0; \
+    for (size_t i=0;  i<sz;  ++i) { \
+        offsets[i] = total; \
+        total += intoFunc( arr[i], NULL, 0 ) + 1; /* +1 for each terminating null. */ \
+        } \
+    offsets[sz] = total; \
+    char* buf = (char*) malloc( MAX(total, (size_t)1) ); \
+    assert(buf != NULL); \
+    for (size_t i=0;  i<sz;  ++i) { \
+        intoFunc( arr[i], buf+offsets[i], offsets[i+1]-offsets[i] ); \
+        } \
+    return buf; \
+    }
+
+char* arrI_toNumerals  MAKE_TO_NUMERALS_FUNC_BODY(int,intToString_into)
+char* arrLi_toNumerals MAKE_TO_NUMERALS_FUNC_BODY(long,longToString_into)
+
 
 /* Return a new string which is the two arguments concatenated.
  * strA, strB should both be non-null.
@@ -195,197 +754,2556 @@ char* newStrCat( stringConst strA, stringConst strB ) {
     }
   }
 
+char* newStrCat_arena( arena* a, stringConst strA, stringConst strB ) {
+    if (strA==NULL && strB==NULL) { return NULL; }
+    size_t const lenA = (strA==NULL ? 0 : strlen(strA));
+    size_t const lenB = (strB==NULL ? 0 : strlen(strB));
+    char* rslt = (char*) arena_allocAligned( a, lenA + lenB + 1, 1 );
+    if (lenA > 0) memcpy( rslt, strA, lenA );
+    if (lenB > 0) memcpy( rslt+lenA, strB, lenB );
+    rslt[lenA+lenB] = '\0';
+    return rslt;
+    }
 
 
-/* 'signum', the sign of a number (+1, 0, or -1).
- * For a templated C++ verison, see: http://stackoverflow.com/a/4609795/320830
- * or use a macro:   #define SGN(x)  (x)>0 ? 1 : ((x)<0 ? -1 : 0)
- * This version relies on implicit casting up to a long double.
- */
-float sgn( long double const x ) { return isnan(x)  ?  NAN  :  ((x > 0) ? 1.0 : ((x < 0) ? -1.0 : 0.0)); }
 
-/* a-b, with a floor of 0.  Helpful for unsgiend arithmetic. */
-// Should make this int,int -> uint ?   ->int?
-int monus( int const a, int const b ) { return a>=b  ?  a-b  :  0; }
-uint monus_u( uint const a, uint const b ) { return a>=b  ?  a-b  :  0; }
+void sb_init( strBuilder* sb ) {
+    sb->str = NULL;
+    sb->len = 0;
+    sb->cap = 0;
+    }
 
-double M_TAU = 2* M_PI; // hmm, misleading to name it "M_", since it's not actually in math.h?
-double degToRad(double const theta) { return theta/360 * M_TAU; }
-double radToDeg(double const theta) { return theta/M_TAU * 360; }
+/* Make sure there is room for at least `extra` more chars (beyond the current length).
+ * We grow by (at least) doubling, so that a sequence of appends is amortized-linear.
+ */
+void sb_reserve( strBuilder* sb, size_t extra ) {
+    size_t const needed = sb->len + extra + 1;  // +1 for the terminating null.
+    if (needed <= sb->cap) return;
+    size_t newCap = MAX(sb->cap*2, (size_t)16);
+    while (newCap < needed) newCap *= 2;
+    char* newStr = (char*) realloc( sb->str, newCap );
+    assert(newStr != NULL);
+    if (sb->str == NULL) newStr[0] = '\0';
+    sb->str = newStr;
+    sb->cap = newCap;
+    }
 
+void sb_appendn( strBuilder* sb, const char* s, size_t n ) {
+    sb_reserve(sb, n);
+    memcpy(sb->str + sb->len, s, n);
+    sb->len += n;
+    sb->str[sb->len] = '\0';
+    }
 
-/* modPos is like %, except that return val is in [0, b), not (-b, b) */
-int modPos( int const n, int const b ) {
-  return (sgn(n%b) != -sgn(b))  ?  n%b  :  (n%b + b);
-  }
-long lmodPos( long int const n, long int const b ) {
-  return (sgn(n%b) != -sgn(b))  ?  n%b  :  n%b + b;
-  }
+void sb_append( strBuilder* sb, stringConst s ) {
+    if (s != NULL) sb_appendn(sb, s, strlen(s));
+    }
 
-bool isinfinite( double x ) {
-    return !isfinite(x) && !isnan(x);
+static void sb_vappendf( strBuilder* sb, stringConst fmt, va_list args ) {
+    sb_reserve(sb, 0);
+    va_list argsAgain;
+    va_copy(argsAgain, args);
+    int n = vsnprintf(sb->str + sb->len, sb->cap - sb->len, fmt, args);
+    assert(n >= 0);
+    if ((size_t)n >= sb->cap - sb->len) {
+        // Didn't fit; now that we know the exact length, make room and print again.
+        sb_reserve(sb, (size_t)n);
+        vsnprintf(sb->str + sb->len, sb->cap - sb->len, fmt, argsAgain);
+        }
+    va_end(argsAgain);
+    sb->len += (size_t)n;
     }
 
-// Based on:  http://www.cygnus-software.com/papers/comparingfloats/comparingfloats.htm
-// Key observation: the bit-patterns for floats are lexicographic.
-// So to compare floats, cast the bit-patterns to int and check that the difference is small!
-// Only glitch is to handle two's-complement ... and NaNs.
-//
-// Tolerance is, crudely: within 1 in 1,000,000  (2^24 ulps / 10)
-//
-bool approxEqualsUlps(double const x, double const y, ulong const maxUlps) {
-    assert(sizeof(double)==sizeof(long int));
-    if (isnan(x) || isnan(y)) return false;
-    // Make sure maxUlps is non-negative and small enough that the
-    // default NAN won't compare as equal to anything.
-    assert(maxUlps > 0 && maxUlps < 4 * 1024 * 1024);
-    // Treat the bit-patterns as ints:
-    long int const xLong = *(const long int* const)&x;
-    long int const yLong = *(const long int* const)&y;
-    DPRINTF( "x,y as ints: %i,%i.\n", xInt, yInt );
-    // Make lexicographically ordered as a twos-complement int
-    // TODO: should this be 0x80000000 - xInt ?
-    long int const xLongPos = labs(xLong);
-    long int const yLongPos = labs(yLong);
-    DPRINTF( "x,y as complemented ints: %i,%i.\n", xIntPos, yIntPos );
-    return (((ulong) labs(xLongPos - yLongPos)) <= maxUlps);
+void sb_appendf( strBuilder* sb, stringConst fmt, ... ) {
+    va_list args;
+    va_start(args, fmt);
+    sb_vappendf(sb, fmt, args);
+    va_end(args);
     }
 
-// Are two doubles approximately-equal?  
-bool approxEqualsRel(double x, double y, double relativeTolerance, double absoluteTolerance) {
-    if (isnan(x) || isnan(y)) return false;
-    if (isinfinite(x) && isinfinite(y)) return (sgn(x)==sgn(y));
-    if (isinfinite(x) || isinfinite(y)) return false;
-    if (fabs(y-x) <= absoluteTolerance) return true;
-    double const size = MAXF(fabs(x),fabs(y));
-    return fabs(x-y) <= size*relativeTolerance;
+/* Return the built string (trimmed to size), and reset `sb` to empty.
+ * The string is heap-allocated; IT IS THE CALLER'S RESPONSIBILITY TO FREE THE STRING when done with it.
+ */
+char* sb_finish( strBuilder* sb ) {
+    sb_reserve(sb, 0);  // so that an empty builder still yields "", not NULL.
+    char* rslt = (char*) realloc( sb->str, sb->len + 1 );
+    if (rslt == NULL) rslt = sb->str;  // shrinking failed?! Just hand back the roomier buffer.
+    sb_init(sb);
+    return rslt;
     }
 
-bool approxEquals(double const x, double const y) { 
-    return approxEqualsRel(x,y,0.00001, 1e-9);
+void sb_free( strBuilder* sb ) {
+    free(sb->str);
+    sb_init(sb);
     }
 
 
-pid_t forkAndExec( stringConst cmd ) {
-    pid_t proc;
 
-    proc = fork();
-    if (proc==0) { 
-        execl( cmd, cmd, NULL); 
-        fprintf( stdout, "%s: ", cmd );
-        perror("exec'ing failed"); 
-        exit(errno);
+/* Arenas.
+ * Each chunk is a header followed (at ARENA_ALIGNMENT) by its bytes.
+ * The chunks in use form a list from a->chunk back to a->first;  released default-size chunks go on a->spare.
+ */
+struct arenaChunk {
+    struct arenaChunk* prev;
+    size_t size;  // of the bytes following the header
+    _Alignas(max_align_t) char bytes[];
+    };
+
+static struct arenaChunk* arena_newChunk( size_t const size ) {
+    struct arenaChunk* c = (struct arenaChunk*) malloc( sizeof(struct arenaChunk) + size );
+    assert(c != NULL);
+    c->size = size;
+    return c;
+    }
+
+/* Make `c` the current chunk. */
+static void arena_pushChunk( arena* a, struct arenaChunk* c ) {
+    c->prev = a->chunk;
+    a->chunk = c;
+    a->next = c->bytes;
+    a->end = c->bytes + c->size;
+    }
+
+void arena_init( arena* a, size_t chunkSize ) {
+    a->chunkSize = (chunkSize == 0 ? ARENA_DEFAULT_CHUNK : chunkSize);
+    a->chunk = NULL;
+    a->spare = NULL;
+    arena_pushChunk( a, arena_newChunk(a->chunkSize) );
+    a->first = a->chunk;
+    }
+
+void* arena_allocSlow( arena* a, size_t size, size_t alignment ) {
+    assert(alignment != 0  &&  (alignment & (alignment-1)) == 0);
+    size_t const worstCase = size + alignment - 1;
+    assert(worstCase >= size);  // (no overflow)
+    if (worstCase > a->chunkSize) {
+        arena_pushChunk( a, arena_newChunk(worstCase) );  // a chunk all its own
         }
-    else if (proc < 1) {
-        fprintf(stderr, "forking %s failed.", cmd );
-        /* This function should really be provided a cleanup-callback, if doing this properly. */
-        exit(proc);
+    else if (a->spare != NULL) {
+        struct arenaChunk* const c = a->spare;
+        a->spare = c->prev;
+        arena_pushChunk( a, c );
         }
-    return proc;
+    else {
+        arena_pushChunk( a, arena_newChunk(a->chunkSize) );
+        }
+    return arena_allocAligned(a, size, alignment);  // (which now fits)
     }
 
+arenaMark arena_mark( const arena* a ) {
+    arenaMark const m = { a->chunk, a->next };
+    return m;
+    }
 
+void arena_rewind( arena* a, arenaMark m ) {
+    while (a->chunk != m.chunk) {
+        struct arenaChunk* const c = a->chunk;
+        assert(c != a->first);  // (else, m wasn't from this arena -- or was already rewound past)
+        a->chunk = c->prev;
+        if (c->size == a->chunkSize) { c->prev = a->spare;  a->spare = c; }
+        else { free(c); }
+        }
+    a->next = m.next;
+    a->end = a->chunk->bytes + a->chunk->size;
+    }
 
+void arena_reset( arena* a ) {
+    arenaMark const start = { a->first, a->first->bytes };
+    arena_rewind(a, start);
+    }
 
-/* Return a string representation of an array, arr[0]..arr[sz-1].
- * arr -- the beginning of the array
- * sz -- the number of elements of the array
- * open -- a string to start the array with.  If NULL, `"["` is used.
- * formatSpec -- the printf-style format string to use for a single element.
- * between -- a printf-compatible string for putting between each element (not after the last).  If NULL, `","` is used.
- * close -- a string to start the array with.  If NULL, `"]"` is used.
- *
- * The result will be a string of length: strlen(open) + (n-1)*strlen(between) + strlen(close)
- *   plus the characters needed for the actual data (which depends on the data and the formatSpec).
- * BUG: If an individual element needs more then MAX_ELT_LEN characters, it gets truncated.
- */
-#define MAX_ELT_LEN  1024
-static char* _nextElt = NULL;
+void arena_free( arena* a ) {
+    arena_reset(a);
+    free(a->first);
+    while (a->spare != NULL) {
+        struct arenaChunk* const c = a->spare;
+        a->spare = c->prev;
+        free(c);
+        }
+    a->chunk = a->first = NULL;
+    a->next = a->end = NULL;
+    }
 
-#define MAKE_SPRINTF_ARR_FUNC_BODY(typ,defaultFormatSpec)\
-( const typ* const arr, const int sz, \
-  stringConst _open, stringConst _formatSpec, stringConst _between, stringConst _close ) { \
-    if (_nextElt == NULL) _nextElt = (char*)malloc(MAX_ELT_LEN);  /* one-time static init */ \
-    stringConst open       = (_open      ==NULL  ?  "["   :  _open      ); \
-    stringConst formatSpec = (_formatSpec==NULL  ?  defaultFormatSpec  :  _formatSpec); \
-    stringConst between    = (_between   ==NULL  ?  ","   :  _between   ); \
-    stringConst close      = (_close     ==NULL  ?  "]"   :  _close     ); \
- \
-    char const * ssf = (open==NULL  ?  "["  :  open); \
-    for (int i=0;  i<sz;  ++i) { \
-        snprintf(_nextElt, MAX_ELT_LEN, formatSpec, arr[i]); \
-        ssf = newStrCat(ssf,_nextElt); \
-        if (i+1 != sz) ssf = newStrCat(ssf, (between==NULL  ?  ","  :  between)); \
-        } \
-    ssf = newStrCat(ssf, (close==NULL  ?  "]"  :  close)); \
-    return ssf; \
+char* sb_finish_arena( strBuilder* sb, arena* a ) {
+    char* rslt = (char*) arena_allocAligned( a, sb->len + 1, 1 );
+    if (sb->str != NULL) { memcpy( rslt, sb->str, sb->len + 1 ); }
+    else { rslt[0] = '\0'; }
+    sb_free(sb);
+    return rslt;
     }
 
-stringConst arrB_toString MAKE_SPRINTF_ARR_FUNC_BODY(bool,"%i")
-stringConst arrC_toString  MAKE_SPRINTF_ARR_FUNC_BODY(char,"%c")
-stringConst arrI_toString  MAKE_SPRINTF_ARR_FUNC_BODY(int,"%i")
-stringConst arrF_toString  MAKE_SPRINTF_ARR_FUNC_BODY(float,"%f")
-stringConst arrLi_toString MAKE_SPRINTF_ARR_FUNC_BODY(long int,"%li")
-stringConst arrLf_toString MAKE_SPRINTF_ARR_FUNC_BODY(double,"%lf")
 
-/* N.B. I tried making a generic verion of the above, passing in
- * sizeOfElement -- the sizeof a single array-element (e.g., pass in sizeof(long))
- * but this doesn't work because when dereferencing, 'void*' isn't allowed (nor would
- * it work with sizeofElt < sizeof(void*)), so I cast arr to a char*.
- * But then when printf is given a value, it used only the first byte.
+/* Pools.
+ * A free object's first word links to the next free object (in a thread's cache, or within one chain of p->batches);
+ * the first object of each chain in p->batches uses its second word to link to the next chain.
+ * Lock order:  poolRegistryLock, then a pool's own lock.
  */
+#define POOL_SLAB_BYTES ((size_t)64*1024)
+#define NEXT_OBJ(obj)    (((void**)(obj))[0])
+#define NEXT_CHAIN(obj)  (((void**)(obj))[1])
 
-#define SWAP_BODY(typ)\
-( typ * a, typ * b ) { \
-    typ tmp = *a; \
-    *a = *b; \
-    *b = tmp; \
-    }
-
-void swap_b SWAP_BODY(bool)
-void swap_c SWAP_BODY(char)
-void swap_i SWAP_BODY(int)
-void swap_u SWAP_BODY(uint)
-void swap_l SWAP_BODY(long)
-void swap_ul SWAP_BODY(ulong)
-void swap_f SWAP_BODY(float)
-void swap_d SWAP_BODY(double)
+_Thread_local poolCache poolCaches[POOL_CACHE_SLOTS];
 
+static pthread_mutex_t poolRegistryLock = PTHREAD_MUTEX_INITIALIZER;
+static pool* livePools = NULL;  // (so that a cache can tell whether its pool still exists)
+static ulong poolEpochs = 0;
+static pthread_key_t poolThreadKey;
+static pthread_once_t poolThreadKeyOnce = PTHREAD_ONCE_INIT;
 
-uint strtou_or_die( stringConst valAsStr, stringConst valRepresents ) {
-    errno = 0;
-    long val = strtol(valAsStr,NULL,0);
-    if (errno) { fprintf(stderr, "%s: %s is invalid %s: %s\n", "strtou_or_die", valRepresents, valAsStr, strerror(errno)); exit(errno); }
-    if (!(0 <= val && val <= UINT_MAX)) { fprintf(stderr, "%s: %s must be in [%i,%u]; got \"%s\" (%li).\n", "strtou_or_die", valRepresents, 0, UINT_MAX, valAsStr, val); exit(ERANGE); }
-    return (uint)val;
+void pool_init( pool* p, size_t objSize, size_t align ) {
+    p->align = MAX(align, _Alignof(void*));
+    assert((p->align & (p->align-1)) == 0);
+    size_t const sz = MAX(objSize, 2*sizeof(void*));
+    p->objSize = (sz + p->align-1) & ~(p->align-1);
+    pthread_mutex_init(&p->lock, NULL);
+    p->batches = NULL;
+    p->slabNext = p->slabEnd = NULL;
+    p->slabs = NULL;
+    memset(&p->stats, 0, sizeof(p->stats));
+    pthread_mutex_lock(&poolRegistryLock);
+    p->epoch = ++poolEpochs;
+    p->nextLive = livePools;
+    livePools = p;
+    pthread_mutex_unlock(&poolRegistryLock);
     }
 
-/* Convert a string to an int.  Exit if string isn't a valid int, with `valRepresents` used in the error message. 
- * Exit with the EINVAL or ERANGE.
- */
-int strtoi_or_die( stringConst valAsStr, stringConst valRepresents ) {
-    errno = 0;
-    long val = strtol(valAsStr,NULL,0);
-    if (errno) { fprintf(stderr, "%s: %s is invalid %s: %s\n", "strtoi_or_die", valRepresents, valAsStr, strerror(errno)); exit(errno); }
-    if (!(INT_MIN <= val && val <= INT_MAX)) { fprintf(stderr, "%s: %s must be in [%i,%i]; got \"%s\" (%li).\n", "strtoi_or_die", valRepresents, INT_MIN, INT_MAX, valAsStr, val); exit(ERANGE); }
-    return (int)val;
+/* Add c's pending counts into p->stats.  (Caller holds p->lock.) */
+static void pool_mergeStats( pool* p, poolCache* c ) {
+    p->stats.allocs += c->hits + c->misses;
+    p->stats.cacheHits += c->hits;
+    p->stats.frees += c->frees;
+    c->hits = c->misses = c->frees = 0;
     }
 
+/* Give all of c's objects (and counts) back to its pool -- if that pool still exists -- and empty c. */
+static void pool_evict( poolCache* c ) {
+    if (c->epoch == 0) return;
+    pthread_mutex_lock(&poolRegistryLock);
+    pool* p = livePools;
+    while (p != NULL  &&  !(p == c->owner && p->epoch == c->epoch)) { p = p->nextLive; }
+    if (p != NULL) {
+        pthread_mutex_lock(&p->lock);
+        if (c->head != NULL) {
+            NEXT_CHAIN(c->head) = p->batches;
+            p->batches = c->head;
+            ++p->stats.flushes;
+            }
+        pool_mergeStats(p, c);
+        pthread_mutex_unlock(&p->lock);
+        }
+    pthread_mutex_unlock(&poolRegistryLock);
+    memset(c, 0, sizeof(*c));
+    }
 
-int* newArrayI_uninit( uint sz ) {
-    assert(sz>0);
-    int* arr = malloc(sz*sizeof(int));
-    assert (arr!=NULL);
-    return arr;
+static void pool_threadExit( __attribute__((unused)) void* unused ) {
+    for (uint i=0;  i<POOL_CACHE_SLOTS;  ++i) { pool_evict(&poolCaches[i]); }
     }
-int* fillArrayI( int* arr, uint sz, int val ) { 
-    for (uint i=0;  i<sz;  ++i) { arr[i] = val; } 
-    return arr;
+static void pool_makeThreadKey() { pthread_key_create(&poolThreadKey, pool_threadExit); }
+
+/* This thread's cache-slot for p, taking it over (from whatever other pool) if need be. */
+static poolCache* pool_claimCache( pool* p ) {
+    poolCache* const c = &poolCaches[p->epoch % POOL_CACHE_SLOTS];
+    if (c->epoch != p->epoch) {
+        pool_evict(c);
+        c->epoch = p->epoch;
+        c->owner = p;
+        pthread_once(&poolThreadKeyOnce, pool_makeThreadKey);
+        pthread_setspecific(poolThreadKey, poolCaches);  // (any non-NULL value, so that pool_threadExit gets called)
+        }
+    return c;
+    }
+
+/* Return a chain of (up to POOL_BATCH) fresh objects from the newest slab, starting a new slab if need be.
+ * (Caller holds p->lock.)
+ */
+static void* pool_carve( pool* p, uint* count ) {
+    if ((size_t)(p->slabEnd - p->slabNext) < p->objSize) {
+        size_t const bytes = MAX(POOL_SLAB_BYTES, sizeof(void*) + p->align + POOL_BATCH*p->objSize);
+        char* const slab = (char*) malloc(bytes);
+        assert(slab != NULL);
+        *(void**)slab = p->slabs;
+        p->slabs = slab;
+        uintptr_t const start = ((uintptr_t)slab + sizeof(void*) + p->align-1) & ~(uintptr_t)(p->align-1);
+        p->slabNext = (char*)start;
+        p->slabEnd = slab + bytes;
+        ++p->stats.slabs;
+        p->stats.slabBytes += bytes;
+        }
+    uint const n = (uint) MIN((size_t)POOL_BATCH, (size_t)(p->slabEnd - p->slabNext) / p->objSize);
+    char* const first = p->slabNext;
+    for (uint i=0;  i+1<n;  ++i) { NEXT_OBJ(first + i*p->objSize) = first + (i+1)*p->objSize; }
+    NEXT_OBJ(first + (n-1)*p->objSize) = NULL;
+    p->slabNext += n*p->objSize;
+    *count = n;
+    return first;
+    }
+
+void* pool_allocSlow( pool* p ) {
+    poolCache* const c = pool_claimCache(p);
+    if (c->head == NULL) {
+        pthread_mutex_lock(&p->lock);
+        ++p->stats.refills;
+        pool_mergeStats(p, c);
+        bool const fromBatches = (p->batches != NULL);
+        if (fromBatches) {
+            c->head = p->batches;
+            p->batches = NEXT_CHAIN(c->head);
+            }
+        else {
+            c->head = pool_carve(p, &c->count);
+            }
+        pthread_mutex_unlock(&p->lock);
+        if (fromBatches) {
+            c->count = 0;
+            for (void* obj = c->head;  obj != NULL;  obj = NEXT_OBJ(obj)) { ++c->count; }
+            }
+        }
+    void* const obj = c->head;
+    c->head = NEXT_OBJ(obj);
+    --c->count;
+    ++c->misses;
+    return obj;
+    }
+
+void pool_freeSlow( pool* p, void* obj ) {
+    poolCache* const c = pool_claimCache(p);
+    if (c->count >= 2*POOL_BATCH) {
+        // Hand a batch back to the pool, for other threads.
+        void* const chain = c->head;
+        void* last = chain;
+        for (uint i=1;  i<POOL_BATCH;  ++i) { last = NEXT_OBJ(last); }
+        c->head = NEXT_OBJ(last);
+        NEXT_OBJ(last) = NULL;
+        c->count -= POOL_BATCH;
+        pthread_mutex_lock(&p->lock);
+        NEXT_CHAIN(chain) = p->batches;
+        p->batches = chain;
+        ++p->stats.flushes;
+        pool_mergeStats(p, c);
+        pthread_mutex_unlock(&p->lock);
+        }
+    NEXT_OBJ(obj) = c->head;
+    c->head = obj;
+    ++c->count;
+    ++c->frees;
+    }
+
+void pool_destroy( pool* p ) {
+    pthread_mutex_lock(&poolRegistryLock);
+    pool** prev = &livePools;
+    while (*prev != NULL  &&  *prev != p) { prev = &(*prev)->nextLive; }
+    if (*prev == p) *prev = p->nextLive;
+    pthread_mutex_unlock(&poolRegistryLock);
+    poolCache* const c = &poolCaches[p->epoch % POOL_CACHE_SLOTS];
+    if (c->epoch == p->epoch) memset(c, 0, sizeof(*c));  // (other threads' caches just never match again)
+    while (p->slabs != NULL) {
+        void* const slab = p->slabs;
+        p->slabs = *(void**)slab;
+        free(slab);
+        }
+    pthread_mutex_destroy(&p->lock);
+    p->epoch = 0;
+    }
+
+poolStats pool_stats( pool* p ) {
+    poolCache* const c = &poolCaches[p->epoch % POOL_CACHE_SLOTS];
+    pthread_mutex_lock(&p->lock);
+    if (c->epoch == p->epoch) pool_mergeStats(p, c);
+    poolStats const s = p->stats;
+    pthread_mutex_unlock(&p->lock);
+    return s;
+    }
+
+void printPoolStats( FILE* f, stringConst name, poolStats const s ) {
+    fprintf( f, "%s: %lu allocs (%.1f%% from thread caches), %lu frees, %lu refills, %lu flushes, %lu slabs (%zu bytes)\n",
+             name, s.allocs, (s.allocs == 0 ? 0.0 : 100.0 * (double)s.cacheHits / (double)s.allocs),
+             s.frees, s.refills, s.flushes, s.slabs, s.slabBytes );
+    }
+
+
+/* Interning.
+ * The strings live in entries (with their hash and length, for quick comparison) in t->strings.
+ * t->slots is an open-addressed table of pointers to those entries, at most half full, with linear probing.
+ * Readers take no lock:  an entry is completely written before its slot is set (release/acquire),
+ * and entries are never removed.  A table that fills up is replaced by a bigger copy -- but the old one
+ * is kept (since some reader may still be probing it) until internTable_free.
+ */
+struct internEntry {
+    ulong  hash;
+    size_t len;
+    char   str[];
+    };
+struct internSlots {
+    size_t cap;  // a power of 2
+    struct internSlots* older;
+    _Atomic(struct internEntry*) slot[];
+    };
+#define INTERN_MIN_SLOTS 64
+
+struct internTable {
+    _Atomic(struct internSlots*) slots;  // replaced (not freed) when it grows
+    pthread_mutex_t lock;  // for adding
+    size_t count;
+    arena* strings;   // where the strings are kept:  ownStrings, or the caller's
+    arena  ownStrings;
+    };
+
+internTable* internTable_new( arena* strings ) {
+    internTable* const t = ALLOC(internTable);
+    assert(t != NULL);
+    atomic_init(&t->slots, NULL);
+    pthread_mutex_init(&t->lock, NULL);
+    t->count = 0;
+    if (strings == NULL) {
+        arena_init(&t->ownStrings, 0);
+        t->strings = &t->ownStrings;
+        }
+    else {
+        t->strings = strings;
+        }
+    return t;
+    }
+
+void internTable_free( internTable* t ) {
+    struct internSlots* tbl = atomic_load(&t->slots);
+    while (tbl != NULL) {
+        struct internSlots* const older = tbl->older;
+        free(tbl);
+        tbl = older;
+        }
+    if (t->strings == &t->ownStrings) arena_free(&t->ownStrings);
+    pthread_mutex_destroy(&t->lock);
+    free(t);
+    }
+
+static struct internEntry* intern_find( struct internSlots* tbl, const char* s, size_t len, ulong h ) {
+    if (tbl == NULL) return NULL;
+    size_t const mask = tbl->cap - 1;
+    for (size_t i = h & mask;  ;  i = (i+1) & mask) {
+        struct internEntry* const e = atomic_load_explicit(&tbl->slot[i], memory_order_acquire);
+        if (e == NULL) return NULL;
+        if (e->hash == h  &&  e->len == len  &&  memcmp(e->str, s, len) == 0) return e;
+        }
+    }
+
+static void intern_place( struct internSlots* tbl, struct internEntry* e ) {
+    size_t const mask = tbl->cap - 1;
+    size_t i = e->hash & mask;
+    while (atomic_load_explicit(&tbl->slot[i], memory_order_relaxed) != NULL) { i = (i+1) & mask; }
+    atomic_store_explicit(&tbl->slot[i], e, memory_order_release);
+    }
+
+/* Replace t's table with one twice as big.  (Caller holds t->lock.) */
+static struct internSlots* intern_grow( internTable* t, struct internSlots* tbl ) {
+    size_t const cap = (tbl == NULL) ? INTERN_MIN_SLOTS : 2*tbl->cap;
+    struct internSlots* const bigger = (struct internSlots*) calloc( 1, sizeof(struct internSlots) + cap*sizeof(bigger->slot[0]) );
+    assert(bigger != NULL);
+    bigger->cap = cap;
+    bigger->older = tbl;
+    for (size_t i=0;  tbl != NULL && i<tbl->cap;  ++i) {
+        struct internEntry* const e = atomic_load_explicit(&tbl->slot[i], memory_order_relaxed);
+        if (e != NULL) intern_place(bigger, e);
+        }
+    atomic_store_explicit(&t->slots, bigger, memory_order_release);
+    return bigger;
+    }
+
+stringConst internTable_lookupn( internTable* t, const char* s, size_t len ) {
+    ulong const h = strnHash(s, len);
+    struct internSlots* tbl = atomic_load_explicit(&t->slots, memory_order_acquire);
+    for (;;) {
+        struct internEntry* const e = intern_find(tbl, s, len, h);
+        if (e != NULL) return e->str;
+        // New strings only go into the newest table.  So a miss is definitive -- unless that table
+        // has since been outgrown (and s perhaps added to the bigger one), in which case look there.
+        struct internSlots* const newest = atomic_load_explicit(&t->slots, memory_order_acquire);
+        if (newest == tbl) return NULL;
+        tbl = newest;
+        }
+    }
+stringConst internTable_lookup( internTable* t, stringConst s ) { return internTable_lookupn(t, s, strlen(s)); }
+
+stringConst internTable_internn( internTable* t, const char* s, size_t len ) {
+    ulong const h = strnHash(s, len);
+    struct internEntry* e = intern_find( atomic_load_explicit(&t->slots, memory_order_acquire), s, len, h );
+    if (e != NULL) return e->str;
+    pthread_mutex_lock(&t->lock);
+    struct internSlots* tbl = atomic_load_explicit(&t->slots, memory_order_relaxed);
+    e = intern_find(tbl, s, len, h);  // (in case another thread just added it)
+    if (e == NULL) {
+        if (tbl == NULL  ||  2*(t->count+1) > tbl->cap) tbl = intern_grow(t, tbl);
+        e = (struct internEntry*) arena_allocAligned( t->strings, sizeof(struct internEntry) + len + 1, _Alignof(struct internEntry) );
+        e->hash = h;
+        e->len = len;
+        memcpy(e->str, s, len);
+        e->str[len] = '\0';
+        intern_place(tbl, e);
+        ++t->count;
+        }
+    pthread_mutex_unlock(&t->lock);
+    return e->str;
+    }
+stringConst internTable_intern( internTable* t, stringConst s ) { return internTable_internn(t, s, strlen(s)); }
+
+size_t internTable_count( internTable* t ) {
+    pthread_mutex_lock(&t->lock);
+    size_t const n = t->count;
+    pthread_mutex_unlock(&t->lock);
+    return n;
+    }
+
+static internTable* globalInterns;
+static pthread_once_t globalInternsOnce = PTHREAD_ONCE_INIT;
+static void initGlobalInterns() { globalInterns = internTable_new(NULL); }
+
+stringConst internn( const char* s, size_t len ) {
+    pthread_once(&globalInternsOnce, initGlobalInterns);
+    return internTable_internn(globalInterns, s, len);
+    }
+stringConst intern( stringConst s ) { return internn(s, strlen(s)); }
+stringConst intern_lookup( stringConst s ) {
+    pthread_once(&globalInternsOnce, initGlobalInterns);
+    return internTable_lookup(globalInterns, s);
+    }
+
+
+
+/* 'signum', the sign of a number (+1, 0, or -1).
+ * For a templated C++ verison, see: http://stackoverflow.com/a/4609795/320830
+ * or use a macro:   #define SGN(x)  (x)>0 ? 1 : ((x)<0 ? -1 : 0)
+ * This version relies on implicit casting up to a long double.
+ */
+float sgn( long double const x ) { return isnan(x)  ?  NAN  :  ((x > 0) ? 1.0 : ((x < 0) ? -1.0 : 0.0)); }
+
+/* a-b, with a floor of 0.  Helpful for unsgiend arithmetic. */
+// Should make this int,int -> uint ?   ->int?
+int monus( int const a, int const b ) { return a>=b  ?  a-b  :  0; }
+uint monus_u( uint const a, uint const b ) { return a>=b  ?  a-b  :  0; }
+
+/* What this CPU has, looked up once (by whichever thread gets there first).
+ * Several array functions below have an AVX2 version, used when the CPU has it;
+ * filling also wants the last-level cache size.
+ */
+static struct { bool avx2, sse2;  size_t cacheBytes; } cpu;
+static pthread_once_t cpuOnce = PTHREAD_ONCE_INIT;
+
+static void initCpu() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    cpu.avx2 = __builtin_cpu_supports("avx2");
+    cpu.sse2 = __builtin_cpu_supports("sse2");
+#endif
+    long cacheBytes = 0;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    cacheBytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (cacheBytes <= 0) cacheBytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    cpu.cacheBytes = (cacheBytes > 0)  ?  (size_t)cacheBytes  :  (size_t)8<<20;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+static bool haveAvx2() {
+    pthread_once(&cpuOnce, initCpu);
+    return cpu.avx2;
+    }
+#endif
+
+
+/* Angles.
+ * Conversions multiply by a (compile-time) constant, rather than dividing.
+ * Normalizing subtracts the right multiple of tau, which is done in two parts (tau's double, then what
+ * that double is missing), so that the result is as accurate as theta itself is.
+ */
+#define TAU_HI   6.28318530717958623200e+00   // M_TAU, rounded to a double
+#define TAU_LO   2.44929359829470641435e-16   // M_TAU - TAU_HI
+#define TAU_HI_F 6.28318548202514648438e+00f
+#define TAU_LO_F (-1.74845560007449702546e-07f)
+
+double degToRad(double const theta) { return theta * (M_TAU/360); }
+double radToDeg(double const theta) { return theta * (360/M_TAU); }
+static inline float degToRadF(float const theta) { return theta * (float)(M_TAU/360); }
+static inline float radToDegF(float const theta) { return theta * (float)(360/M_TAU); }
+
+/* Like modPos, for doubles:  x mod b, with the result having the sign of b (so, in [0,b) for positive b). */
+double fmodPos( double const x, double const b ) {
+    double const r = fmod(x, b);
+    return (r != 0 && ((r < 0) != (b < 0)))  ?  r + b  :  r;
+    }
+
+/* theta, in [0, tau).
+ * k*tau can be off by one step (r a hair below 0, or rounding up to exactly tau); fix that with one more
+ * add or subtract.  (The conditions just choose a constant, so the compiler can use a select, not a branch.)
+ */
+double angleNormalize( double const theta ) {
+    double const k = floor( theta * (1/M_TAU) );
+    double r = (theta - k*TAU_HI) - k*TAU_LO;
+    r += (r < 0)  ?  TAU_HI  :  0.0;
+    return r - ((r >= TAU_HI)  ?  TAU_HI  :  0.0);
+    }
+static inline float angleNormalizeF( float const theta ) {
+    float const k = floorf( theta * (float)(1/M_TAU) );
+    float r = (theta - k*TAU_HI_F) - k*TAU_LO_F;
+    r += (r < 0)  ?  TAU_HI_F  :  0.0f;
+    return r - ((r >= TAU_HI_F)  ?  TAU_HI_F  :  0.0f);
+    }
+
+/* theta, in (-pi, pi]. */
+double angleNormalizeSigned( double const theta ) {
+    double const r = angleNormalize(theta);
+    return r - ((r > M_PI)  ?  TAU_HI  :  0.0);
+    }
+static inline float angleNormalizeSignedF( float const theta ) {
+    float const r = angleNormalizeF(theta);
+    return r - ((r > (float)M_PI)  ?  TAU_HI_F  :  0.0f);
+    }
+
+/* The array versions:  out[i] = f(thetas[i]), for i<sz (out may be thetas itself).
+ * The conversions are each one multiply, so the loop is written once, and the compiler vectorizes it
+ * for plain SSE2, and again (8 floats or 4 doubles at a time) in the copy compiled for AVX2.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#define MAKE_ANGLE_ARR_FUNC(name, typ, eltFunc) \
+static inline void name##_loop( const typ* thetas, ulong const sz, typ* out ) { \
+    for (ulong i=0;  i<sz;  ++i) { out[i] = eltFunc(thetas[i]); } \
+    } \
+__attribute__((target("avx2"))) \
+static void name##_avx2( const typ* thetas, ulong const sz, typ* out ) { name##_loop(thetas, sz, out); } \
+void name( const typ* thetas, ulong const sz, typ* out ) { \
+    if (haveAvx2()) name##_avx2(thetas, sz, out); \
+    else name##_loop(thetas, sz, out); \
+    }
+#else
+#define MAKE_ANGLE_ARR_FUNC(name, typ, eltFunc) \
+void name( const typ* thetas, ulong const sz, typ* out ) { \
+    for (ulong i=0;  i<sz;  ++i) { out[i] = eltFunc(thetas[i]); } \
+    }
+#endif
+
+MAKE_ANGLE_ARR_FUNC(degToRadArr,  double, degToRad)
+MAKE_ANGLE_ARR_FUNC(degToRadArrF, float,  degToRadF)
+MAKE_ANGLE_ARR_FUNC(radToDegArr,  double, radToDeg)
+MAKE_ANGLE_ARR_FUNC(radToDegArrF, float,  radToDegF)
+
+/* Normalizing, though, the compiler won't vectorize (it won't turn the fix-up compares into masks),
+ * so for AVX2 we spell it out.  `isSigned` adds the last step of angleNormalizeSigned.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+__attribute__((target("avx2")))
+static void angleNormalizeArr_avx2( const double* thetas, ulong const sz, double* out, bool const isSigned ) {
+    __m256d const invTau = _mm256_set1_pd(1/M_TAU);
+    __m256d const hi = _mm256_set1_pd(TAU_HI);
+    __m256d const lo = _mm256_set1_pd(TAU_LO);
+    __m256d const pi = _mm256_set1_pd(isSigned ? M_PI : INFINITY);
+    __m256d const zero = _mm256_setzero_pd();
+    ulong i = 0;
+    for (;  i + 4 <= sz;  i += 4) {
+        __m256d const x = _mm256_loadu_pd(thetas+i);
+        __m256d const k = _mm256_floor_pd( _mm256_mul_pd(x, invTau) );
+        __m256d r = _mm256_sub_pd( _mm256_sub_pd(x, _mm256_mul_pd(k, hi)), _mm256_mul_pd(k, lo) );
+        r = _mm256_add_pd( r, _mm256_and_pd( _mm256_cmp_pd(r, zero, _CMP_LT_OQ), hi ) );
+        r = _mm256_sub_pd( r, _mm256_and_pd( _mm256_cmp_pd(r, hi, _CMP_GE_OQ), hi ) );
+        r = _mm256_sub_pd( r, _mm256_and_pd( _mm256_cmp_pd(r, pi, _CMP_GT_OQ), hi ) );
+        _mm256_storeu_pd( out+i, r );
+        }
+    for (;  i<sz;  ++i) { out[i] = isSigned  ?  angleNormalizeSigned(thetas[i])  :  angleNormalize(thetas[i]); }
+    }
+
+__attribute__((target("avx2")))
+static void angleNormalizeArrF_avx2( const float* thetas, ulong const sz, float* out, bool const isSigned ) {
+    __m256 const invTau = _mm256_set1_ps((float)(1/M_TAU));
+    __m256 const hi = _mm256_set1_ps(TAU_HI_F);
+    __m256 const lo = _mm256_set1_ps(TAU_LO_F);
+    __m256 const pi = _mm256_set1_ps(isSigned ? (float)M_PI : INFINITY);
+    __m256 const zero = _mm256_setzero_ps();
+    ulong i = 0;
+    for (;  i + 8 <= sz;  i += 8) {
+        __m256 const x = _mm256_loadu_ps(thetas+i);
+        __m256 const k = _mm256_floor_ps( _mm256_mul_ps(x, invTau) );
+        __m256 r = _mm256_sub_ps( _mm256_sub_ps(x, _mm256_mul_ps(k, hi)), _mm256_mul_ps(k, lo) );
+        r = _mm256_add_ps( r, _mm256_and_ps( _mm256_cmp_ps(r, zero, _CMP_LT_OQ), hi ) );
+        r = _mm256_sub_ps( r, _mm256_and_ps( _mm256_cmp_ps(r, hi, _CMP_GE_OQ), hi ) );
+        r = _mm256_sub_ps( r, _mm256_and_ps( _mm256_cmp_ps(r, pi, _CMP_GT_OQ), hi ) );
+        _mm256_storeu_ps( out+i, r );
+        }
+    for (;  i<sz;  ++i) { out[i] = isSigned  ?  angleNormalizeSignedF(thetas[i])  :  angleNormalizeF(thetas[i]); }
+    }
+#define IF_AVX2_ANGLE_NORMALIZE(arrFunc, thetas, sz, out, isSigned) \
+    if (haveAvx2()) { arrFunc##_avx2(thetas, sz, out, isSigned);  return; }
+#else
+#define IF_AVX2_ANGLE_NORMALIZE(arrFunc, thetas, sz, out, isSigned)
+#endif
+
+void angleNormalizeArr( const double* thetas, ulong const sz, double* out ) {
+    IF_AVX2_ANGLE_NORMALIZE(angleNormalizeArr, thetas, sz, out, false)
+    for (ulong i=0;  i<sz;  ++i) { out[i] = angleNormalize(thetas[i]); }
+    }
+void angleNormalizeArrF( const float* thetas, ulong const sz, float* out ) {
+    IF_AVX2_ANGLE_NORMALIZE(angleNormalizeArrF, thetas, sz, out, false)
+    for (ulong i=0;  i<sz;  ++i) { out[i] = angleNormalizeF(thetas[i]); }
+    }
+void angleNormalizeSignedArr( const double* thetas, ulong const sz, double* out ) {
+    IF_AVX2_ANGLE_NORMALIZE(angleNormalizeArr, thetas, sz, out, true)
+    for (ulong i=0;  i<sz;  ++i) { out[i] = angleNormalizeSigned(thetas[i]); }
+    }
+void angleNormalizeSignedArrF( const float* thetas, ulong const sz, float* out ) {
+    IF_AVX2_ANGLE_NORMALIZE(angleNormalizeArrF, thetas, sz, out, true)
+    for (ulong i=0;  i<sz;  ++i) { out[i] = angleNormalizeSignedF(thetas[i]); }
+    }
+
+
+/* Bulk trigonometry:  sin, cos, sincos, atan2 over arrays, at a chosen accuracy.
+ *
+ * sin/cos:  write x = k*(pi/2) + r, with |r| <= pi/4 -- k by rounding (add and subtract 1.5*2^52, after which
+ * the low bits of the sum *are* k), and r by subtracting k*(pi/2) in three pieces, each short enough that
+ * k*piece is exact.  Then sin r and cos r are polynomials (fdlibm's minimax coefficients -- all of them, for
+ * TRIG_FULL;  the first few, for the cheaper tiers), and k mod 4 picks which one, and its sign.
+ * That reduction is good for |x| up to about a million (8192 for floats);  a block of inputs with anything
+ * larger (or inf, or NaN) goes element-by-element, with libm for the large ones.
+ *
+ * atan2:  atan of min(|x|,|y|)/max(|x|,|y|) (in [0,1]), then reflect into the right octant.
+ * For TRIG_FULL, Cephes's rational approximation (after shifting a > 0.66 by pi/4);
+ * for the cheaper tiers, odd polynomials fit (minimax, on [0,1]) to errors of 8e-5 and 2.5e-7.
+ *
+ * Everything inside the loops is arithmetic and bit-masking selects (no branches), so that they vectorize;
+ * as with the angle functions, there's a copy of each loop compiled for AVX2.
+ */
+#define TRIG_BLOCK 256
+
+#define ROUND_MAGIC   6755399441055744.0   // 1.5 * 2^52
+#define ROUND_MAGIC_F 12582912.0f          // 1.5 * 2^23
+
+#define PIO2_1  1.57079632673412561417e+00   // (fdlibm's)
+#define PIO2_2  6.07710050630396597660e-11
+#define PIO2_3  2.02226624871116645580e-21
+#define TRIG_REDUCE_LIMIT 1.0e6
+#define PIO2_1F 1.5703125f                   // (Cephes's)
+#define PIO2_2F 4.837512969970703125e-4f
+#define PIO2_3F 7.54978995489188216e-8f
+#define TRIG_REDUCE_LIMIT_F 8192.0f
+
+#define SIN_S1 -1.66666666666666324348e-01
+#define SIN_S2  8.33333333332248946124e-03
+#define SIN_S3 -1.98412698298579493134e-04
+#define SIN_S4  2.75573137070700676789e-06
+#define SIN_S5 -2.50507602534068634195e-08
+#define SIN_S6  1.58969099521155010221e-10
+#define COS_C1  4.16666666666666019037e-02
+#define COS_C2 -1.38888888888741095749e-03
+#define COS_C3  2.48015872894767294178e-05
+#define COS_C4 -2.75573143513906633035e-07
+#define COS_C5  2.08757232129817482790e-09
+#define COS_C6 -1.13596475577881948265e-11
+
+/* sin r and cos r, for |r| <= pi/4 (z = r*r). */
+__attribute__((always_inline)) static inline double sinPoly( double const r, double const z, trigAccuracy const acc ) {
+    double const v = r*z;
+    if (acc == TRIG_FAST)   return r + v*(SIN_S1 + z*SIN_S2);
+    if (acc == TRIG_MEDIUM) return r + v*(SIN_S1 + z*(SIN_S2 + z*SIN_S3));
+    return r + v*(SIN_S1 + z*(SIN_S2 + z*(SIN_S3 + z*(SIN_S4 + z*(SIN_S5 + z*SIN_S6)))));
+    }
+__attribute__((always_inline)) static inline double cosPoly( double const z, trigAccuracy const acc ) {
+    double const hz = 0.5*z;
+    if (acc == TRIG_FAST)   return (1.0 - hz) + z*z*COS_C1;
+    if (acc == TRIG_MEDIUM) return (1.0 - hz) + z*z*(COS_C1 + z*(COS_C2 + z*COS_C3));
+    double const w = 1.0 - hz;   // (and then add back what that subtraction lost)
+    return w + (((1.0 - w) - hz) + z*z*(COS_C1 + z*(COS_C2 + z*(COS_C3 + z*(COS_C4 + z*(COS_C5 + z*COS_C6))))));
+    }
+__attribute__((always_inline)) static inline float sinPolyF( float const r, float const z, trigAccuracy const acc ) {
+    float const v = r*z;
+    if (acc == TRIG_FAST)   return r + v*((float)SIN_S1 + z*(float)SIN_S2);
+    if (acc == TRIG_MEDIUM) return r + v*((float)SIN_S1 + z*((float)SIN_S2 + z*(float)SIN_S3));
+    return r + v*((float)SIN_S1 + z*((float)SIN_S2 + z*((float)SIN_S3 + z*(float)SIN_S4)));
+    }
+__attribute__((always_inline)) static inline float cosPolyF( float const z, trigAccuracy const acc ) {
+    float const hz = 0.5f*z;
+    if (acc == TRIG_FAST)   return (1.0f - hz) + z*z*(float)COS_C1;
+    if (acc == TRIG_MEDIUM) return (1.0f - hz) + z*z*((float)COS_C1 + z*((float)COS_C2 + z*(float)COS_C3));
+    float const w = 1.0f - hz;
+    return w + (((1.0f - w) - hz) + z*z*((float)COS_C1 + z*((float)COS_C2 + z*((float)COS_C3 + z*(float)COS_C4))));
+    }
+
+/* (cond ? a : b), and v negated if `negate` -- both by masking bits, since gcc would otherwise turn a
+ * ?: back into a branch (and then not vectorize).
+ */
+__attribute__((always_inline)) static inline double selectD( bool const cond, double const a, double const b ) {
+    ulong const mask = -(ulong)cond;
+    ulong aBits, bBits;
+    memcpy(&aBits, &a, sizeof(aBits));
+    memcpy(&bBits, &b, sizeof(bBits));
+    ulong const bits = (aBits & mask) | (bBits & ~mask);
+    double result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+    }
+__attribute__((always_inline)) static inline float selectF( bool const cond, float const a, float const b ) {
+    uint const mask = -(uint)cond;
+    uint aBits, bBits;
+    memcpy(&aBits, &a, sizeof(aBits));
+    memcpy(&bBits, &b, sizeof(bBits));
+    uint const bits = (aBits & mask) | (bBits & ~mask);
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+    }
+
+__attribute__((always_inline)) static inline double negateIf( double const v, ulong const negate ) {
+    ulong bits;
+    memcpy(&bits, &v, sizeof(bits));
+    bits ^= negate << 63;
+    double result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+    }
+__attribute__((always_inline)) static inline float negateIfF( float const v, uint const negate ) {
+    uint bits;
+    memcpy(&bits, &v, sizeof(bits));
+    bits ^= negate << 31;
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+    }
+/* (like signbit, which gcc won't vectorize for doubles) */
+__attribute__((always_inline)) static inline ulong signBitD( double const v ) {
+    ulong bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits >> 63;
+    }
+__attribute__((always_inline)) static inline uint signBitF( float const v ) {
+    uint bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return bits >> 31;
+    }
+
+/* x = k*(pi/2) + r:  sin x is (sin r, cos r, -sin r, -cos r) for k = (0,1,2,3) mod 4;  cos x is sin at k+1. */
+__attribute__((always_inline)) static inline void sincosCore( double const x, trigAccuracy const acc, double* s, double* c ) {
+    double const kRounded = x * (2/M_PI) + ROUND_MAGIC;
+    ulong k;
+    memcpy(&k, &kRounded, sizeof(k));
+    double const kf = kRounded - ROUND_MAGIC;
+    double const r = ((x - kf*PIO2_1) - kf*PIO2_2) - kf*PIO2_3;
+    double const z = r*r;
+    double const sr = sinPoly(r, z, acc),  cr = cosPoly(z, acc);
+    *s = negateIf( selectD(k & 1, cr, sr), (k >> 1) & 1 );
+    *c = negateIf( selectD(k & 1, sr, cr), ((k+1) >> 1) & 1 );
+    }
+/* For floats, TRIG_FULL reduces in double:  otherwise, the part of pi/2 that's beyond even PIO2_3F, times k,
+ * is hundreds of ulps of the results nearest 0.
+ */
+__attribute__((always_inline)) static inline void sincosCoreF( float const x, trigAccuracy const acc, float* s, float* c ) {
+    uint k;
+    float r;
+    if (acc == TRIG_FULL) {
+        double const kRounded = (double)x * (2/M_PI) + ROUND_MAGIC;
+        ulong kWide;
+        memcpy(&kWide, &kRounded, sizeof(kWide));
+        k = (uint)kWide;
+        double const kf = kRounded - ROUND_MAGIC;
+        r = (float)(((double)x - kf*PIO2_1) - kf*PIO2_2);
+        }
+    else {
+        float const kRounded = x * (float)(2/M_PI) + ROUND_MAGIC_F;
+        memcpy(&k, &kRounded, sizeof(k));
+        float const kf = kRounded - ROUND_MAGIC_F;
+        r = ((x - kf*PIO2_1F) - kf*PIO2_2F) - kf*PIO2_3F;
+        }
+    float const z = r*r;
+    float const sr = sinPolyF(r, z, acc),  cr = cosPolyF(z, acc);
+    *s = negateIfF( selectF(k & 1, cr, sr), (k >> 1) & 1 );
+    *c = negateIfF( selectF(k & 1, sr, cr), ((k+1) >> 1) & 1 );
+    }
+
+/* sins[i], coss[i] = sin, cos of xs[i]  (for whichever of wantSin, wantCos -- constants, once inlined). */
+#define MAKE_SINCOS_KERNEL(name, typ, core, fabsX, sinX, cosX, limit) \
+__attribute__((always_inline)) static inline void name( const typ* xs, ulong const sz, typ* sins, typ* coss, trigAccuracy const acc, \
+                         bool const wantSin, bool const wantCos ) { \
+    for (ulong start=0;  start<sz;  start += TRIG_BLOCK) { \
+        ulong const n = MIN(TRIG_BLOCK, sz-start); \
+        const typ* const x = xs + start; \
+        typ* const s = sins + (wantSin ? start : 0); \
+        typ* const c = coss + (wantCos ? start : 0); \
+        bool allReducible = true; \
+        for (ulong i=0;  i<n;  ++i) { allReducible &= (fabsX(x[i]) <= (limit)); } \
+        if (allReducible) { \
+            for (ulong i=0;  i<n;  ++i) { \
+                typ si, ci; \
+                core( x[i], acc, &si, &ci ); \
+                if (wantSin) s[i] = si; \
+                if (wantCos) c[i] = ci; \
+                } \
+            } \
+        else { \
+            for (ulong i=0;  i<n;  ++i) { \
+                typ const xi = x[i]; \
+                typ si, ci; \
+                if (fabsX(xi) <= (limit)) { core( xi, acc, &si, &ci ); } \
+                else { si = sinX(xi);  ci = cosX(xi); } \
+                if (wantSin) s[i] = si; \
+                if (wantCos) c[i] = ci; \
+                } \
+            } \
+        } \
+    }
+MAKE_SINCOS_KERNEL(sincosKernel,  double, sincosCore,  fabs,  sin,  cos,  TRIG_REDUCE_LIMIT)
+MAKE_SINCOS_KERNEL(sincosKernelF, float,  sincosCoreF, fabsf, sinf, cosf, TRIG_REDUCE_LIMIT_F)
+
+
+#define ATAN_P0 -8.750608600031904122785e-01   // (Cephes's)
+#define ATAN_P1 -1.615753718733365076637e+01
+#define ATAN_P2 -7.500855792314704667340e+01
+#define ATAN_P3 -1.228866684490136173410e+02
+#define ATAN_P4 -6.485021904942025371773e+01
+#define ATAN_Q0  2.485846490142306297962e+01
+#define ATAN_Q1  1.650270098316988542046e+02
+#define ATAN_Q2  4.328810604912902668951e+02
+#define ATAN_Q3  4.853903996359136964868e+02
+#define ATAN_Q4  1.945506571482613964425e+02
+#define PIO4_LO  3.061616997868382943065e-17   // pi/4 - (double)(pi/4)
+
+/* atan a, for a in [0,1]. */
+__attribute__((always_inline)) static inline double atanUnit( double const a, trigAccuracy const acc ) {
+    double const s = a*a;
+    if (acc == TRIG_FAST) {
+        return a*(9.99213813257235496969e-01 + s*(-3.21174969709241186030e-01 + s*(1.46264459554021675460e-01
+                 + s*-3.89865102157506591603e-02)));
+        }
+    if (acc == TRIG_MEDIUM) {
+        return a*(9.99996111561964674851e-01 + s*(-3.33173680718000374837e-01 + s*(1.98078156313402195136e-01
+                 + s*(-1.32333421740043881347e-01 + s*(7.96236719452557519512e-02 + s*(-3.36042191997152250322e-02
+                 + s*6.81179262426756409365e-03))))));
+        }
+    bool const shift = (a > 0.66);
+    double const t = selectD( shift, (a - 1.0) / (a + 1.0), a );
+    double const z = t*t;
+    double const p = (((ATAN_P0*z + ATAN_P1)*z + ATAN_P2)*z + ATAN_P3)*z + ATAN_P4;
+    double const q = ((((z + ATAN_Q0)*z + ATAN_Q1)*z + ATAN_Q2)*z + ATAN_Q3)*z + ATAN_Q4;
+    double const atanT = t + t*(z*p/q);
+    return selectD(shift, M_PI_4, 0.0) + (atanT + selectD(shift, PIO4_LO, 0.0));
+    }
+__attribute__((always_inline)) static inline float atanUnitF( float const a, trigAccuracy const acc ) {
+    float const s = a*a;
+    if (acc == TRIG_FAST) {
+        return a*(9.99213813257235496969e-01f + s*(-3.21174969709241186030e-01f + s*(1.46264459554021675460e-01f
+                 + s*-3.89865102157506591603e-02f)));
+        }
+    if (acc == TRIG_MEDIUM) {
+        return a*(9.99996111561964674851e-01f + s*(-3.33173680718000374837e-01f + s*(1.98078156313402195136e-01f
+                 + s*(-1.32333421740043881347e-01f + s*(7.96236719452557519512e-02f + s*(-3.36042191997152250322e-02f
+                 + s*6.81179262426756409365e-03f))))));
+        }
+    bool const shift = (a > 0.4142135623730950f);  // (Cephes's atanf)
+    float const t = selectF( shift, (a - 1.0f) / (a + 1.0f), a );
+    float const z = t*t;
+    float const atanT = t + t*z*(((8.05374449538e-2f*z - 1.38776856032e-1f)*z + 1.99777106478e-1f)*z - 3.33329491539e-1f);
+    return selectF(shift, (float)M_PI_4, 0.0f) + atanT;
+    }
+
+/* atan2(y,x):  a = min(|x|,|y|)/max(|x|,|y|) (0, if both are 0;  1, if both infinite), then
+ * reflect atan a about pi/4 if |y| > |x|, about pi/2 if x is negative (incl. -0), and take y's sign.
+ */
+#define MAKE_ATAN2_CORE(name, typ, atanUnitX, fabsX, selectX, signBitX, negateIfX, PI_HI, PI_LO) \
+__attribute__((always_inline)) static inline typ name( typ const y, typ const x, trigAccuracy const acc ) { \
+    typ const ax = fabsX(x),  ay = fabsX(y); \
+    bool const steep = (ay > ax); \
+    typ const big = selectX(steep, ay, ax),  small = selectX(steep, ax, ay); \
+    typ a = small / big; \
+    a = selectX( big == 0, (typ)0, a ); \
+    a = selectX( small == (typ)INFINITY, (typ)1, a ); \
+    typ p = atanUnitX(a, acc); \
+    p = selectX( steep, ((typ)(PI_HI/2) - p) + (typ)(PI_LO/2), p ); \
+    p = selectX( signBitX(x), ((typ)PI_HI - p) + (typ)PI_LO, p ); \
+    p = negateIfX( p, signBitX(y) );  /* (p is in [0,pi]) */ \
+    return selectX( (x != x) | (y != y), x + y, p ); \
+    }
+#define PI_HI_D 3.14159265358979311600e+00   // (double)pi, and the rest of pi
+#define PI_LO_D 1.22464679914735317723e-16
+MAKE_ATAN2_CORE(atan2Core,  double, atanUnit,  fabs,  selectD, signBitD, negateIf,  PI_HI_D, PI_LO_D)
+MAKE_ATAN2_CORE(atan2CoreF, float,  atanUnitF, fabsf, selectF, signBitF, negateIfF, PI_HI_D, 0.0)
+
+#define MAKE_ATAN2_KERNEL(name, typ, core) \
+__attribute__((always_inline)) static inline void name( const typ* ys, const typ* xs, ulong const sz, typ* out, trigAccuracy const acc ) { \
+    for (ulong i=0;  i<sz;  ++i) { out[i] = core(ys[i], xs[i], acc); } \
+    }
+MAKE_ATAN2_KERNEL(atan2Kernel,  double, atan2Core)
+MAKE_ATAN2_KERNEL(atan2KernelF, float,  atan2CoreF)
+
+
+/* Each public function:  pick the accuracy (so that each loop is compiled with it as a constant),
+ * and -- where the CPU has it -- use the copy compiled for AVX2.
+ */
+#define TRIG_ACCURACY_CASES(call) \
+    switch (acc) { \
+        case TRIG_FAST:   call(TRIG_FAST);    break; \
+        case TRIG_MEDIUM: call(TRIG_MEDIUM);  break; \
+        default:          call(TRIG_FULL);    break; \
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MAKE_TRIG_ARR_FUNC(name, params, args, call) \
+static void name##_generic params { TRIG_ACCURACY_CASES(call) } \
+__attribute__((target("avx2"))) \
+static void name##_avx2 params { TRIG_ACCURACY_CASES(call) } \
+void name params { \
+    if (haveAvx2()) name##_avx2 args; \
+    else name##_generic args; \
+    }
+#else
+#define MAKE_TRIG_ARR_FUNC(name, params, args, call) \
+void name params { TRIG_ACCURACY_CASES(call) }
+#endif
+
+#define CALL_SIN(a)    sincosKernel(xs, sz, out, NULL, a, true, false)
+#define CALL_COS(a)    sincosKernel(xs, sz, NULL, out, a, false, true)
+#define CALL_SINCOS(a) sincosKernel(xs, sz, sins, coss, a, true, true)
+#define CALL_ATAN2(a)  atan2Kernel(ys, xs, sz, out, a)
+#define CALL_SIN_F(a)    sincosKernelF(xs, sz, out, NULL, a, true, false)
+#define CALL_COS_F(a)    sincosKernelF(xs, sz, NULL, out, a, false, true)
+#define CALL_SINCOS_F(a) sincosKernelF(xs, sz, sins, coss, a, true, true)
+#define CALL_ATAN2_F(a)  atan2KernelF(ys, xs, sz, out, a)
+
+MAKE_TRIG_ARR_FUNC(sinArr, (const double* xs, ulong const sz, double* out, trigAccuracy const acc), (xs, sz, out, acc), CALL_SIN)
+MAKE_TRIG_ARR_FUNC(cosArr, (const double* xs, ulong const sz, double* out, trigAccuracy const acc), (xs, sz, out, acc), CALL_COS)
+MAKE_TRIG_ARR_FUNC(sincosArr, (const double* xs, ulong const sz, double* sins, double* coss, trigAccuracy const acc),
+                              (xs, sz, sins, coss, acc), CALL_SINCOS)
+MAKE_TRIG_ARR_FUNC(atan2Arr, (const double* ys, const double* xs, ulong const sz, double* out, trigAccuracy const acc),
+                             (ys, xs, sz, out, acc), CALL_ATAN2)
+MAKE_TRIG_ARR_FUNC(sinArrF, (const float* xs, ulong const sz, float* out, trigAccuracy const acc), (xs, sz, out, acc), CALL_SIN_F)
+MAKE_TRIG_ARR_FUNC(cosArrF, (const float* xs, ulong const sz, float* out, trigAccuracy const acc), (xs, sz, out, acc), CALL_COS_F)
+MAKE_TRIG_ARR_FUNC(sincosArrF, (const float* xs, ulong const sz, float* sins, float* coss, trigAccuracy const acc),
+                               (xs, sz, sins, coss, acc), CALL_SINCOS_F)
+MAKE_TRIG_ARR_FUNC(atan2ArrF, (const float* ys, const float* xs, ulong const sz, float* out, trigAccuracy const acc),
+                              (ys, xs, sz, out, acc), CALL_ATAN2_F)
+
+
+/* modPos is like %, except that return val is in [0, b), not (-b, b)
+ * (More precisely:  the result has the sign of b.)
+ * % truncates, so its result r has the sign of n;  when r is non-zero and of the opposite sign from b,
+ * add b once.  All in integers, with the condition as a mask rather than a branch.
+ */
+int modPos( int const n, int const b ) {
+  int const r = n%b;
+  int const needsB = -(int)(((r ^ b) < 0) & (r != 0));
+  return r + (b & needsB);
+  }
+long lmodPos( long int const n, long int const b ) {
+  long const r = n%b;
+  long const needsB = -(long)(((r ^ b) < 0) & (r != 0));
+  return r + (b & needsB);
+  }
+
+
+/* Precomputed divisors, for many `modPos(n,b)` with the same b:
+ * Lemire, Kaser & Kurz's "direct remainder" (Faster Remainder by Direct Computation, 2019):
+ * with M = ceil(2^64 / d), the fractional part of n/d is (M*n mod 2^64), and multiplying that by d
+ * and keeping the high 64 bits gives exactly n mod d, for every 32-bit unsigned n.
+ * For signed n, we shift to unsigned by adding 2^31 (and then take back 2^31 mod d);
+ * for negative b, the floored result is either 0 or (the result for |b|) + b.
+ */
+void moddiv_init( moddiv_t* div, int const b ) {
+    assert(b != 0);
+    div->b = b;
+    div->absB = (b < 0)  ?  0u - (uint)b  :  (uint)b;
+    div->M = ULONG_MAX / div->absB + 1;           // (for |b|==1, that wraps to 0 -- which works.)
+    div->offsetMod = (uint)((1UL << 31) % div->absB);
+    }
+
+static inline uint fastmod_u( uint const u, ulong const M, uint const d ) {
+    ulong const lowbits = M * u;
+    return (uint)(((__uint128_t)lowbits * d) >> 64);
+    }
+
+static inline int modPos_byInline( int const n, const moddiv_t* const div ) {
+    uint const u = (uint)n ^ 0x80000000u;   // n + 2^31, as unsigned.
+    int r = (int)fastmod_u(u, div->M, div->absB) - (int)div->offsetMod;
+    r += (int)div->absB & -(int)(r < 0);
+    int const negB = -(int)(div->b < 0);
+    return r + (div->b & negB & -(int)(r != 0));
+    }
+
+int modPos_by( int const n, const moddiv_t* div ) {
+    return modPos_byInline(n, div);
+    }
+
+/* out[i] = modPos(ns[i], b), for i<sz.  (out may be ns itself.) */
+void modPosArr( const int* ns, ulong const sz, int const b, int* out ) {
+    moddiv_t div;
+    moddiv_init(&div, b);
+    modPosArr_by( ns, sz, &div, out );
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+/* fastmod_u on the 4 uints in the low halves of each 64-bit lane of u.
+ * AVX2 only multiplies 32x32->64, so:  the low 64 bits of M*u are mLo*u + ((mHi*u mod 2^32) << 32);
+ * and the high 64 bits of (that)*d are (lowbits.hi*d + (lowbits.lo*d >> 32)) >> 32.
+ */
+__attribute__((target("avx2")))
+static inline __m256i fastmod_u_avx2( __m256i const u, __m256i const mLo, __m256i const mHi, __m256i const d ) {
+    __m256i const lowbits = _mm256_add_epi64( _mm256_mul_epu32(u, mLo),
+                                              _mm256_slli_epi64( _mm256_mullo_epi32(u, mHi), 32 ) );
+    __m256i const loPart = _mm256_srli_epi64( _mm256_mul_epu32(lowbits, d), 32 );
+    __m256i const hiPart = _mm256_mul_epu32( _mm256_srli_epi64(lowbits, 32), d );
+    return _mm256_srli_epi64( _mm256_add_epi64(hiPart, loPart), 32 );
+    }
+
+__attribute__((target("avx2")))
+static void modPosArr_by_avx2( const int* ns, ulong const sz, moddiv_t const div, int* out ) {
+    __m256i const mLo = _mm256_set1_epi32( (int)(uint)div.M );
+    __m256i const mHi = _mm256_set1_epi32( (int)(uint)(div.M >> 32) );
+    __m256i const d = _mm256_set1_epi32( (int)div.absB );
+    __m256i const offset = _mm256_set1_epi32( (int)div.offsetMod );
+    __m256i const signFlip = _mm256_set1_epi32( INT_MIN );
+    __m256i const bIfNeg = _mm256_set1_epi32( (div.b < 0) ? div.b : 0 );
+    ulong i = 0;
+    for (;  i + 8 <= sz;  i += 8) {
+        __m256i const u = _mm256_xor_si256( _mm256_loadu_si256((const __m256i*)(ns+i)), signFlip );
+        __m256i const even = fastmod_u_avx2( u, mLo, mHi, d );
+        __m256i const odd  = fastmod_u_avx2( _mm256_srli_epi64(u, 32), mLo, mHi, d );
+        __m256i r = _mm256_blend_epi32( even, _mm256_slli_epi64(odd, 32), 0xAA );
+        r = _mm256_sub_epi32( r, offset );
+        r = _mm256_add_epi32( r, _mm256_and_si256( d, _mm256_srai_epi32(r, 31) ) );
+        __m256i const isZero = _mm256_cmpeq_epi32( r, _mm256_setzero_si256() );
+        r = _mm256_add_epi32( r, _mm256_andnot_si256( isZero, bIfNeg ) );
+        _mm256_storeu_si256( (__m256i*)(out+i), r );
+        }
+    for (;  i<sz;  ++i) { out[i] = modPos_byInline(ns[i], &div); }
+    }
+#endif
+
+void modPosArr_by( const int* ns, ulong const sz, const moddiv_t* div, int* out ) {
+    moddiv_t const d = *div;   // (a local copy, so the compiler needn't worry that writing `out` changes it.)
+#if defined(__x86_64__) || defined(__i386__)
+    if (haveAvx2()) { modPosArr_by_avx2( ns, sz, d, out );  return; }
+#endif
+    for (ulong i=0;  i<sz;  ++i) { out[i] = modPos_byInline(ns[i], &d); }
+    }
+
+bool isinfinite( double x ) {
+    return !isfinite(x) && !isnan(x);
+    }
+
+// Based on:  http://www.cygnus-software.com/papers/comparingfloats/comparingfloats.htm
+// Key observation: the bit-patterns for floats are lexicographic.
+// So to compare floats, view the bit-patterns as ints and check that the difference is small!
+// Only glitches are that floats are sign-magnitude, not two's-complement ... and NaNs.
+//
+// We view the bits via memcpy (which compiles to a register move; a pointer-cast breaks strict aliasing),
+// and map sign-magnitude to two's-complement by negating the magnitude of negatives -- so -0.0 and +0.0 are
+// both 0, and -denorm_min is one step below either.  Everything is arithmetic on masks; no branches.
+
+/* x as an integer, ordered the same as x (and adjacent doubles are adjacent integers). */
+static inline long orderedBits( double const x ) {
+    ulong bits;
+    memcpy(&bits, &x, sizeof(bits));
+    long const mag = (long)(bits & ~(1UL << 63));
+    long const neg = -(long)(bits >> 63);   // all ones, if x is negative.
+    return (mag ^ neg) - neg;
+    }
+static inline int orderedBitsF( float const x ) {
+    uint bits;
+    memcpy(&bits, &x, sizeof(bits));
+    int const mag = (int)(bits & ~(1U << 31));
+    int const neg = -(int)(bits >> 31);
+    return (mag ^ neg) - neg;
+    }
+
+ulong ulpDistance( double const x, double const y ) {
+    long const a = orderedBits(x),  b = orderedBits(y);
+    ulong const diff = (ulong)a - (ulong)b;
+    ulong const flip = -(ulong)(a < b);
+    ulong const nanMask = -(ulong)(isnan(x) | isnan(y));
+    return ((diff ^ flip) - flip) | nanMask;
+    }
+
+uint ulpDistanceF( float const x, float const y ) {
+    int const a = orderedBitsF(x),  b = orderedBitsF(y);
+    uint const diff = (uint)a - (uint)b;
+    uint const flip = -(uint)(a < b);
+    uint const nanMask = -(uint)(isnan(x) | isnan(y));
+    return ((diff ^ flip) - flip) | nanMask;
+    }
+
+bool approxEqualsUlps( double const x, double const y, ulong const maxUlps ) {
+    return !isnan(x) && !isnan(y) && ulpDistance(x,y) <= maxUlps;
+    }
+
+
+/* Bucket 0 holds distance 0, bucket 1 distance 1, and bucket k>1 holds (4^(k-2), 4^(k-1)].
+ * With c = ceil(log2(d)), that's bucket ceil(c/2)+1 (for any d>0).
+ */
+static inline uint ulpBucket( ulong const d ) {
+    uint const ceilLog2 = (uint)(64 - __builtin_clzl((d-1) | 1)) - (uint)(d == 1);
+    return (uint)(d != 0) * ((ceilLog2 + 1) / 2 + 1);
+    }
+
+ulong ulpBucketLow( uint const bucket ) {
+    return (bucket <= 1)  ?  bucket  :  (1UL << (2*(bucket-2))) + 1;
+    }
+ulong ulpBucketHigh( uint const bucket ) {
+    return (bucket == 0)  ?  0  :  (bucket >= ULP_HISTOGRAM_BUCKETS-1)  ?  ULONG_MAX  :  1UL << (2*(bucket-1));
+    }
+
+void ulpHistogram_init( ulpHistogram* hist ) {
+    memset(hist, 0, sizeof(*hist));
+    }
+
+/* The batch versions:  distances computed branch-free (and vectorizable, when there's no histogram);
+ * the histogram is kept as two interleaved halves, so that consecutive equal buckets don't serialize
+ * on one counter.
+ */
+#define MAKE_ULP_DISTANCE_ARR_FUNC_BODY(typ, distTyp, ulpDistanceX) \
+( const typ* xs, const typ* ys, ulong sz, distTyp* dists, ulpHistogram* hist ) { \
+    if (hist == NULL) { \
+        for (ulong i=0;  i<sz;  ++i) { dists[i] = ulpDistanceX(xs[i], ys[i]); } \
+        return; \
+        } \
+    ulong counts[2][ULP_HISTOGRAM_BUCKETS]; \
+    memset(counts, 0, sizeof(counts)); \
+    ulong maxUlps = hist->maxUlps; \
+    for (ulong i=0;  i<sz;  ++i) { \
+        distTyp const d = ulpDistanceX(xs[i], ys[i]); \
+        if (dists != NULL) dists[i] = d; \
+        ulong const dWide = ((ulong)d) | -(ulong)(d == (distTyp)-1);  /* (keep "NaN" as the maximum.) */ \
+        ++counts[i&1][ulpBucket(dWide)]; \
+        maxUlps = MAX(maxUlps, dWide); \
+        } \
+    for (uint k=0;  k<ULP_HISTOGRAM_BUCKETS;  ++k) { hist->counts[k] += counts[0][k] + counts[1][k]; } \
+    hist->total += sz; \
+    hist->maxUlps = maxUlps; \
+    }
+
+void ulpDistanceArr  MAKE_ULP_DISTANCE_ARR_FUNC_BODY(double, ulong, ulpDistance)
+void ulpDistanceArrF MAKE_ULP_DISTANCE_ARR_FUNC_BODY(float,  uint,  ulpDistanceF)
+
+void printUlpHistogram( FILE* out, const ulpHistogram* hist ) {
+    fprintf( out, "%lu comparisons;  max error %lu ulps%s\n",
+             hist->total, hist->maxUlps, (hist->maxUlps == ULONG_MAX ? " (NaN)" : "") );
+    for (uint k=0;  k<ULP_HISTOGRAM_BUCKETS;  ++k) {
+        if (hist->counts[k] == 0) continue;
+        ulong const lo = ulpBucketLow(k),  hi = ulpBucketHigh(k);
+        char range[48];
+        if (lo == hi) snprintf( range, sizeof(range), "%lu", lo );
+        else          snprintf( range, sizeof(range), "%lu-%lu", lo, hi );
+        fprintf( out, "  %26s ulps: %12lu  (%.4f%%)\n", range, hist->counts[k], 100.0 * (double)hist->counts[k] / (double)hist->total );
+        }
+    }
+
+// Are two doubles approximately-equal?  
+bool approxEqualsRel(double x, double y, double relativeTolerance, double absoluteTolerance) {
+    if (isnan(x) || isnan(y)) return false;
+    if (isinfinite(x) && isinfinite(y)) return (sgn(x)==sgn(y));
+    if (isinfinite(x) || isinfinite(y)) return false;
+    if (fabs(y-x) <= absoluteTolerance) return true;
+    double const size = MAXF(fabs(x),fabs(y));
+    return fabs(x-y) <= size*relativeTolerance;
+    }
+
+bool approxEquals(double const x, double const y) { 
+    return approxEqualsRel(x,y,0.00001, 1e-9);
+    }
+
+
+/* Whole-array versions of approxEqualsRel.
+ * Each element's verdict is computed without branching (so the loops vectorize), as:
+ *     x==y  ||  (|x-y| < inf  &&  (|x-y| <= absTol  ||  |x-y| <= max(|x|,|y|)*relTol))
+ * which agrees with approxEqualsRel:  x==y catches equal infinities; and |x-y| is NaN or inf exactly when
+ * some input is NaN or inf (or the difference overflows), all of which approxEqualsRel rejects.
+ */
+#define APPROX_EQUALS_ELT(typ, fabsX, x, y, relTol, absTol) \
+    ( ((x)==(y)) | ((fabsX((x)-(y)) < (typ)INFINITY) \
+                   & ((fabsX((x)-(y)) <= (absTol)) | (fabsX((x)-(y)) <= MAXF(fabsX(x),fabsX(y))*(relTol)))) )
+
+#define MAKE_APPROX_EQUALS_ARR_SCALAR(suffix, typ, fabsX) \
+static void approxEqualsArr##suffix##_scalar( const typ* xs, const typ* ys, ulong start, ulong sz, \
+                                              typ relTol, typ absTol, arrMismatches* result ) { \
+    for (ulong i = start;  i < sz;  ++i) { \
+        bool const ok = APPROX_EQUALS_ELT(typ, fabsX, xs[i], ys[i], relTol, absTol); \
+        if (!ok) { \
+            if (result->count == 0) result->first = (long)i; \
+            ++result->count; \
+            } \
+        } \
+    }
+MAKE_APPROX_EQUALS_ARR_SCALAR(D, double, fabs)
+MAKE_APPROX_EQUALS_ARR_SCALAR(F, float, fabsf)
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+/* Record the lanes of `okBits` (one bit per lane, `lanes` of them) which are 0, for the block starting at i. */
+static inline void recordMismatches( uint const okBits, uint const lanes, ulong const i, arrMismatches* result ) {
+    uint const badBits = ~okBits & ((1u << lanes) - 1);
+    if (badBits != 0) {
+        if (result->count == 0) result->first = (long)(i + (ulong)__builtin_ctz(badBits));
+        result->count += (ulong)__builtin_popcount(badBits);
+        }
+    }
+
+__attribute__((target("avx2")))
+static void approxEqualsArrD_avx2( const double* xs, const double* ys, ulong sz,
+                                   double relTol, double absTol, arrMismatches* result ) {
+    __m256d const signBit = _mm256_set1_pd(-0.0);
+    __m256d const inf = _mm256_set1_pd(INFINITY);
+    __m256d const rel = _mm256_set1_pd(relTol);
+    __m256d const abs = _mm256_set1_pd(absTol);
+    ulong i = 0;
+    for (;  i + 4 <= sz;  i += 4) {
+        __m256d const x = _mm256_loadu_pd(xs+i);
+        __m256d const y = _mm256_loadu_pd(ys+i);
+        __m256d const d = _mm256_andnot_pd( signBit, _mm256_sub_pd(x,y) );
+        __m256d const size = _mm256_max_pd( _mm256_andnot_pd(signBit,x), _mm256_andnot_pd(signBit,y) );
+        __m256d const within = _mm256_or_pd( _mm256_cmp_pd(d, abs, _CMP_LE_OQ),
+                                             _mm256_cmp_pd(d, _mm256_mul_pd(size,rel), _CMP_LE_OQ) );
+        __m256d const ok = _mm256_or_pd( _mm256_cmp_pd(x, y, _CMP_EQ_OQ),
+                                         _mm256_and_pd(_mm256_cmp_pd(d, inf, _CMP_LT_OQ), within) );
+        recordMismatches( (uint)_mm256_movemask_pd(ok), 4, i, result );
+        }
+    approxEqualsArrD_scalar( xs, ys, i, sz, relTol, absTol, result );
+    }
+
+__attribute__((target("avx2")))
+static void approxEqualsArrF_avx2( const float* xs, const float* ys, ulong sz,
+                                   float relTol, float absTol, arrMismatches* result ) {
+    __m256 const signBit = _mm256_set1_ps(-0.0f);
+    __m256 const inf = _mm256_set1_ps(INFINITY);
+    __m256 const rel = _mm256_set1_ps(relTol);
+    __m256 const abs = _mm256_set1_ps(absTol);
+    ulong i = 0;
+    for (;  i + 8 <= sz;  i += 8) {
+        __m256 const x = _mm256_loadu_ps(xs+i);
+        __m256 const y = _mm256_loadu_ps(ys+i);
+        __m256 const d = _mm256_andnot_ps( signBit, _mm256_sub_ps(x,y) );
+        __m256 const size = _mm256_max_ps( _mm256_andnot_ps(signBit,x), _mm256_andnot_ps(signBit,y) );
+        __m256 const within = _mm256_or_ps( _mm256_cmp_ps(d, abs, _CMP_LE_OQ),
+                                            _mm256_cmp_ps(d, _mm256_mul_ps(size,rel), _CMP_LE_OQ) );
+        __m256 const ok = _mm256_or_ps( _mm256_cmp_ps(x, y, _CMP_EQ_OQ),
+                                        _mm256_and_ps(_mm256_cmp_ps(d, inf, _CMP_LT_OQ), within) );
+        recordMismatches( (uint)_mm256_movemask_ps(ok), 8, i, result );
+        }
+    approxEqualsArrF_scalar( xs, ys, i, sz, relTol, absTol, result );
+    }
+
+#endif
+
+arrMismatches approxEqualsArrD( const double* xs, const double* ys, ulong sz, double relTol, double absTol ) {
+    arrMismatches result = { 0, -1 };
+#if defined(__x86_64__) || defined(__i386__)
+    if (haveAvx2()) { approxEqualsArrD_avx2( xs, ys, sz, relTol, absTol, &result );  return result; }
+#endif
+    approxEqualsArrD_scalar( xs, ys, 0, sz, relTol, absTol, &result );
+    return result;
+    }
+
+arrMismatches approxEqualsArrF( const float* xs, const float* ys, ulong sz, double relTol, double absTol ) {
+    arrMismatches result = { 0, -1 };
+#if defined(__x86_64__) || defined(__i386__)
+    if (haveAvx2()) { approxEqualsArrF_avx2( xs, ys, sz, (float)relTol, (float)absTol, &result );  return result; }
+#endif
+    approxEqualsArrF_scalar( xs, ys, 0, sz, (float)relTol, (float)absTol, &result );
+    return result;
+    }
+
+
+pid_t forkAndExec( stringConst cmd ) {
+    pid_t proc;
+
+    proc = fork();
+    if (proc==0) { 
+        execl( cmd, cmd, NULL); 
+        fprintf( stdout, "%s: ", cmd );
+        perror("exec'ing failed"); 
+        exit(errno);
+        }
+    else if (proc < 1) {
+        fprintf(stderr, "forking %s failed.", cmd );
+        /* This function should really be provided a cleanup-callback, if doing this properly. */
+        exit(proc);
+        }
+    return proc;
+    }
+
+
+extern char** environ;
+
+void spawnOptions_init( spawnOptions* o ) {
+    for (int k=0;  k<3;  ++k) { o->redirect[k] = (spawnRedirect){ -1, NULL, false }; }
+    o->searchPath = false;
+    }
+
+/* The redirections become posix_spawn "file actions", which the child carries out just before it execs. */
+static int addRedirect( posix_spawn_file_actions_t* actions, int const childFd, const spawnRedirect* r ) {
+    if (r->fd >= 0) {
+        return (r->fd == childFd)  ?  0  :  posix_spawn_file_actions_adddup2(actions, r->fd, childFd);
+        }
+    if (r->path != NULL) {
+        int const flags = (childFd == STDIN_FILENO)  ?  O_RDONLY  :  (O_WRONLY | O_CREAT | (r->append ? O_APPEND : O_TRUNC));
+        return posix_spawn_file_actions_addopen(actions, childFd, r->path, flags, 0666);
+        }
+    return 0;
+    }
+
+int spawnProcess( pid_t* pid, stringConst cmd, stringConst argv[], stringConst envp[], const spawnOptions* opts ) {
+    posix_spawn_file_actions_t actions;
+    int err = posix_spawn_file_actions_init(&actions);
+    if (err != 0) return err;
+    for (int k=0;  k<3 && opts != NULL && err == 0;  ++k) { err = addRedirect(&actions, k, &opts->redirect[k]); }
+    if (err == 0) {
+        stringConst justCmd[] = { cmd, NULL };
+        // (posix_spawn's argv/envp aren't declared const, for historical reasons; but it doesn't modify them.)
+        char* const* const args = (char* const*)(uintptr_t)( (argv != NULL)  ?  argv  :  justCmd );
+        char* const* const env  = (envp != NULL)  ?  (char* const*)(uintptr_t)envp  :  environ;
+        bool const searchPath = (opts != NULL && opts->searchPath);
+        err = searchPath  ?  posix_spawnp(pid, cmd, &actions, NULL, args, env)
+                          :  posix_spawn( pid, cmd, &actions, NULL, args, env);
+        }
+    posix_spawn_file_actions_destroy(&actions);
+    return err;
+    }
+
+
+
+
+/* Return a string representation of an array, arr[0]..arr[sz-1].
+ * arr -- the beginning of the array
+ * sz -- the number of elements of the array
+ * open -- a string to start the array with.  If NULL, `"["` is used.
+ * formatSpec -- the printf-style format string to use for a single element.
+ * between -- a printf-compatible string for putting between each element (not after the last).  If NULL, `","` is used.
+ * close -- a string to start the array with.  If NULL, `"]"` is used.
+ *
+ * The result will be a string of length: strlen(open) + (n-1)*strlen(between) + strlen(close)
+ *   plus the characters needed for the actual data (which depends on the data and the formatSpec).
+ * The result is built in a single strBuilder, so the total work is linear in the result's length.
+ */
+#define TYPICAL_ELT_LEN  8   /* just a guess, for the initial sb_reserve; the builder grows as needed. */
+
+#define MAKE_SPRINTF_ARR_FUNC_BODY(typ,defaultFormatSpec)\
+( const typ* const arr, const int sz, \
+  stringConst _open, stringConst _formatSpec, stringConst _between, stringConst _close ) { \
+    stringConst open       = (_open      ==NULL  ?  "["   :  _open      ); \
+    stringConst formatSpec = (_formatSpec==NULL  ?  defaultFormatSpec  :  _formatSpec); \
+    stringConst between    = (_between   ==NULL  ?  ","   :  _between   ); \
+    stringConst close      = (_close     ==NULL  ?  "]"   :  _close     ); \
+    size_t const betweenLen = strlen(between); \
+ \
+    strBuilder sb; \
+    sb_init(&sb); \
+    sb_reserve(&sb, strlen(open) + (size_t)MAX(sz,0)*(TYPICAL_ELT_LEN+betweenLen) + strlen(close)); \
+    sb_append(&sb, open); \
+    for (int i=0;  i<sz;  ++i) { \
+        sb_appendf(&sb, formatSpec, arr[i]); \
+        if (i+1 != sz) sb_appendn(&sb, between, betweenLen); \
+        } \
+    sb_append(&sb, close); \
+    return sb_finish(&sb); \
+    }
+
+/* arrX_toNewString is arrX_toString, but typed as the caller's own (non-const) string -- for vecX_toString. */
+#define MAKE_ARR_TO_STRING_FUNCS(suffix,typ,defaultFormatSpec) \
+static char* arr##suffix##_toNewString MAKE_SPRINTF_ARR_FUNC_BODY(typ,defaultFormatSpec) \
+stringConst arr##suffix##_toString( const typ* const arr, const int sz, \
+                                    stringConst open, stringConst formatSpec, stringConst between, stringConst close ) { \
+    return arr##suffix##_toNewString( arr, sz, open, formatSpec, between, close ); \
+    }
+MAKE_ARR_TO_STRING_FUNCS(B,bool,"%i")
+MAKE_ARR_TO_STRING_FUNCS(C,char,"%c")
+MAKE_ARR_TO_STRING_FUNCS(I,int,"%i")
+MAKE_ARR_TO_STRING_FUNCS(F,float,"%f")
+MAKE_ARR_TO_STRING_FUNCS(Li,long int,"%li")
+MAKE_ARR_TO_STRING_FUNCS(Lf,double,"%lf")
+
+
+/* The streaming versions, arrX_write and arrX_writeFd:
+ * Text accumulates in a chunkWriter's fixed buffer, which gets flushed (to a FILE* or an fd) whenever it fills.
+ * Anything too big for the buffer on its own (a giant `between`, say) is written straight through.
+ */
+#define WRITE_CHUNK_SIZE  (1<<14)
+
+/* Write all of buf[0,n) to fd, despite partial writes and interruptions.
+ * Return how many bytes were written:  fewer than n only on failure (with errno set).
+ */
+static size_t writeAll( int const fd, const char* buf, size_t const n ) {
+    size_t done = 0;
+    while (done < n) {
+        ssize_t const written = write(fd, buf+done, n-done);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) break;
+        done += (size_t)written;
+        }
+    return done;
+    }
+
+typedef struct {
+    char   buf[WRITE_CHUNK_SIZE];
+    size_t len;
+    FILE*  file;   // If non-NULL, write to this;
+    int    fd;     // otherwise write to this.
+    long   total;  // #bytes successfully handed off so far.
+    bool   failed;
+    } chunkWriter;
+
+static void cw_writeThrough( chunkWriter* cw, const char* s, size_t n ) {
+    if (cw->failed) return;
+    if (cw->file != NULL) {
+        if (fwrite(s, 1, n, cw->file) != n) { cw->failed = true; return; }
+        }
+    else {
+        size_t const written = writeAll(cw->fd, s, n);
+        if (written < n) cw->failed = true;
+        n = written;
+        }
+    cw->total += (long)n;
+    }
+
+static void cw_flush( chunkWriter* cw ) {
+    cw_writeThrough(cw, cw->buf, cw->len);
+    cw->len = 0;
+    }
+
+static void cw_put( chunkWriter* cw, const char* s, size_t n ) {
+    if (cw->len + n > WRITE_CHUNK_SIZE) cw_flush(cw);
+    if (n > WRITE_CHUNK_SIZE) { cw_writeThrough(cw, s, n); return; }
+    memcpy(cw->buf + cw->len, s, n);
+    cw->len += n;
+    }
+
+static void cw_putf( chunkWriter* cw, stringConst fmt, ... ) __attribute__ ((format (printf, 2, 3)));
+static void cw_putf( chunkWriter* cw, stringConst fmt, ... ) {
+    va_list args;
+    va_start(args, fmt);
+    va_list argsAgain;
+    va_copy(argsAgain, args);
+    // N.B. vsnprintf writes a trailing null, so it needs one more byte than the text itself.
+    int n = vsnprintf(cw->buf + cw->len, WRITE_CHUNK_SIZE - cw->len, fmt, args);
+    va_end(args);
+    if (n >= 0 && (size_t)n >= WRITE_CHUNK_SIZE - cw->len) {
+        // Didn't fit in what's left of the chunk: flush, and try again with a whole (empty) chunk.
+        cw_flush(cw);
+        if ((size_t)n < WRITE_CHUNK_SIZE) {
+            vsnprintf(cw->buf, WRITE_CHUNK_SIZE, fmt, argsAgain);
+            }
+        else {
+            // A single element bigger than a whole chunk; rare enough to just allocate.
+            char* big = (char*) malloc( (size_t)n + 1 );
+            assert(big != NULL);
+            vsnprintf(big, (size_t)n + 1, fmt, argsAgain);
+            cw_writeThrough(cw, big, (size_t)n);
+            free(big);
+            n = 0;
+            }
+        }
+    va_end(argsAgain);
+    if (n < 0) { cw->failed = true; n = 0; }
+    cw->len += (size_t)n;
+    }
+
+#define MAKE_WRITE_ARR_FUNCS(suffix,typ,defaultFormatSpec) \
+static long arr##suffix##_writeChunked( chunkWriter* cw, const typ* const arr, const int sz, \
+                                        stringConst _open, stringConst _formatSpec, stringConst _between, stringConst _close ) { \
+    stringConst open       = (_open      ==NULL  ?  "["   :  _open      ); \
+    stringConst formatSpec = (_formatSpec==NULL  ?  defaultFormatSpec  :  _formatSpec); \
+    stringConst between    = (_between   ==NULL  ?  ","   :  _between   ); \
+    stringConst close      = (_close     ==NULL  ?  "]"   :  _close     ); \
+    size_t const betweenLen = strlen(between); \
+    cw->len = 0;  cw->total = 0;  cw->failed = false; \
+ \
+    cw_put(cw, open, strlen(open)); \
+    for (int i=0;  i<sz && !cw->failed;  ++i) { \
+        cw_putf(cw, formatSpec, arr[i]); \
+        if (i+1 != sz) cw_put(cw, between, betweenLen); \
+        } \
+    cw_put(cw, close, strlen(close)); \
+    cw_flush(cw); \
+    return cw->failed  ?  -1  :  cw->total; \
+    } \
+long arr##suffix##_write( FILE* f, const typ* const arr, const int sz, \
+                          stringConst open, stringConst formatSpec, stringConst between, stringConst close ) { \
+    chunkWriter cw; \
+    cw.file = f; \
+    return arr##suffix##_writeChunked(&cw, arr, sz, open, formatSpec, between, close); \
+    } \
+long arr##suffix##_writeFd( int fd, const typ* const arr, const int sz, \
+                            stringConst open, stringConst formatSpec, stringConst between, stringConst close ) { \
+    chunkWriter cw; \
+    cw.file = NULL; \
+    cw.fd = fd; \
+    return arr##suffix##_writeChunked(&cw, arr, sz, open, formatSpec, between, close); \
+    }
+
+MAKE_WRITE_ARR_FUNCS(B,bool,"%i")
+MAKE_WRITE_ARR_FUNCS(C,char,"%c")
+MAKE_WRITE_ARR_FUNCS(I,int,"%i")
+MAKE_WRITE_ARR_FUNCS(F,float,"%f")
+MAKE_WRITE_ARR_FUNCS(Li,long int,"%li")
+MAKE_WRITE_ARR_FUNCS(Lf,double,"%lf")
+
+/* N.B. I tried making a generic verion of the above, passing in
+ * sizeOfElement -- the sizeof a single array-element (e.g., pass in sizeof(long))
+ * but this doesn't work because when dereferencing, 'void*' isn't allowed (nor would
+ * it work with sizeofElt < sizeof(void*)), so I cast arr to a char*.
+ * But then when printf is given a value, it used only the first byte.
+ */
+
+
+/* Binary array files:
+ * an arrayFileHeader, zero-padded to ARRAY_FILE_ALIGNMENT bytes, then the elements' raw bytes.
+ * mmap maps the file at a page boundary, so the elements of a mapped file are ARRAY_FILE_ALIGNMENT-aligned
+ * (as for newArrayX_aligned's arrays).  And unmapArray can find the header -- and so the mapping's length --
+ * just before the array.
+ * The header's fields are fixed-width, and written in the machine's own byte-order;  a file from a machine
+ * with the other byte-order has its byteOrderMark backwards, and is rejected rather than misread.
+ */
+#define ARRAY_FILE_MAGIC      "IBARRAY"   // (8 bytes, counting the null)
+#define ARRAY_FILE_VERSION    1
+#define ARRAY_FILE_BYTE_ORDER 0x01020304U
+#define ARRAY_FILE_ALIGNMENT  64
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t byteOrderMark;  // ARRAY_FILE_BYTE_ORDER
+    uint32_t eltType;        // an arrayFileEltType
+    uint32_t eltSize;        // (checked too:  e.g. long is 4 bytes on some platforms, 8 on others)
+    uint64_t count;
+    uint64_t dataOffset;     // where the elements start:  ARRAY_FILE_ALIGNMENT (for now)
+    } arrayFileHeader;
+_Static_assert(sizeof(arrayFileHeader) <= ARRAY_FILE_ALIGNMENT, "arrayFileHeader must fit in the padded header");
+
+typedef enum { ARRAY_FILE_B = 1, ARRAY_FILE_C, ARRAY_FILE_I, ARRAY_FILE_F, ARRAY_FILE_Li, ARRAY_FILE_Lf } arrayFileEltType;
+
+/* Write to a new file beside `path`, and only once that's complete (and synced), rename it to `path`.
+ * So a failed or interrupted save leaves any previous file intact -- and anybody who has that previous file
+ * mapped (mapArrayX) keeps their mapping of it, rather than having it truncated out from under them.
+ */
+static long saveArrayFile( stringConst path, const void* arr, ulong const count,
+                           arrayFileEltType const eltType, size_t const eltSize ) {
+    static atomic_ulong saves = 0;  // (to keep two threads' temp files apart)
+    strBuilder sb;
+    sb_init(&sb);
+    sb_appendf(&sb, "%s.tmp-%ld-%lu", path, (long)getpid(), atomic_fetch_add(&saves, 1));
+    char* const tmpPath = sb_finish(&sb);
+    int const fd = open(tmpPath, O_WRONLY | O_CREAT | O_EXCL, 0666);
+    if (fd < 0) { int const err = errno;  free(tmpPath);  errno = err;  return -1; }
+    arrayFileHeader const h = { ARRAY_FILE_MAGIC, ARRAY_FILE_VERSION, ARRAY_FILE_BYTE_ORDER,
+                                (uint32_t)eltType, (uint32_t)eltSize, count, ARRAY_FILE_ALIGNMENT };
+    char header[ARRAY_FILE_ALIGNMENT];
+    memset(header, 0, sizeof(header));
+    memcpy(header, &h, sizeof(h));
+    size_t const dataBytes = count*eltSize;
+    bool ok = writeAll(fd, header, sizeof(header)) == sizeof(header)
+           && writeAll(fd, (const char*)arr, dataBytes) == dataBytes
+           && fsync(fd) == 0;
+    int err = ok  ?  0  :  errno;
+    if (close(fd) != 0 && ok) { ok = false;  err = errno; }  // (some filesystems only report a failed write at close)
+    if (ok && rename(tmpPath, path) != 0) { ok = false;  err = errno; }
+    if (!ok) unlink(tmpPath);
+    free(tmpPath);
+    if (!ok) { errno = err;  return -1; }
+    return (long)(sizeof(header) + dataBytes);
+    }
+
+static const void* mapArrayFile( stringConst path, ulong* count, arrayFileEltType const eltType, size_t const eltSize ) {
+    int const fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat info;
+    arrayFileHeader h;
+    if (fstat(fd, &info) != 0) { int const err = errno;  close(fd);  errno = err;  return NULL; }
+    size_t const fileSize = (size_t)info.st_size;
+    bool const valid = fileSize >= ARRAY_FILE_ALIGNMENT
+                    && pread(fd, &h, sizeof(h), 0) == (ssize_t)sizeof(h)
+                    && memcmp(h.magic, ARRAY_FILE_MAGIC, sizeof(h.magic)) == 0
+                    && h.version == ARRAY_FILE_VERSION
+                    && h.byteOrderMark == ARRAY_FILE_BYTE_ORDER
+                    && h.eltType == (uint32_t)eltType
+                    && h.eltSize == (uint32_t)eltSize
+                    && h.dataOffset == ARRAY_FILE_ALIGNMENT
+                    && h.count == (fileSize - ARRAY_FILE_ALIGNMENT) / eltSize
+                    && (fileSize - ARRAY_FILE_ALIGNMENT) % eltSize == 0;
+    if (!valid) { close(fd);  errno = EINVAL;  return NULL; }
+    void* const mapped = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    int const err = errno;
+    close(fd);  // (the mapping stays valid without it)
+    if (mapped == MAP_FAILED) { errno = err;  return NULL; }
+    *count = h.count;
+    return (const char*)mapped + ARRAY_FILE_ALIGNMENT;
+    }
+
+void unmapArray( const void* arr ) {
+    if (arr == NULL) return;
+    const char* const mapped = (const char*)arr - ARRAY_FILE_ALIGNMENT;
+    arrayFileHeader h;
+    memcpy(&h, mapped, sizeof(h));
+    munmap( (void*)(uintptr_t)mapped, ARRAY_FILE_ALIGNMENT + h.count*h.eltSize );
+    }
+
+#define MAKE_ARRAY_FILE_FUNCS(suffix,typ) \
+long saveArray##suffix( stringConst path, const typ* arr, ulong sz ) { \
+    return saveArrayFile( path, arr, sz, ARRAY_FILE_##suffix, sizeof(typ) ); \
+    } \
+const typ* mapArray##suffix( stringConst path, ulong* sz ) { \
+    return (const typ*) mapArrayFile( path, sz, ARRAY_FILE_##suffix, sizeof(typ) ); \
+    }
+MAKE_ARRAY_FILE_FUNCS(B,bool)
+MAKE_ARRAY_FILE_FUNCS(C,char)
+MAKE_ARRAY_FILE_FUNCS(I,int)
+MAKE_ARRAY_FILE_FUNCS(F,float)
+MAKE_ARRAY_FILE_FUNCS(Li,long)
+MAKE_ARRAY_FILE_FUNCS(Lf,double)
+
+#define SWAP_BODY(typ)\
+( typ * a, typ * b ) { \
+    typ tmp = *a; \
+    *a = *b; \
+    *b = tmp; \
+    }
+
+void swap_b SWAP_BODY(bool)
+void swap_c SWAP_BODY(char)
+void swap_i SWAP_BODY(int)
+void swap_u SWAP_BODY(uint)
+void swap_l SWAP_BODY(long)
+void swap_ul SWAP_BODY(ulong)
+void swap_f SWAP_BODY(float)
+void swap_d SWAP_BODY(double)
+
+
+/* Number-parsing:
+ * The core reads an unsigned magnitude, eight digits at a time where it can (SWAR: treat 8 chars
+ * as one 64-bit word, check they're all digits, and combine them pairwise in three multiplies),
+ * then one digit at a time with exact overflow-checks.  Each parse_* then applies its sign and range.
+ * Nothing here calls strtol, allocates, or depends on the locale.
+ */
+/* Are all 8 chars of the word `chunk` in '0'..'9'? */
+static inline bool swar_allDigits( ulong const chunk ) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0UL) | (((chunk + 0x0606060606060606UL) & 0xF0F0F0F0F0F0F0F0UL) >> 4))
+           == 0x3333333333333333UL;
+    }
+
+/* The value of 8 digit-chars (already known to be digits), as laid out little-endian in `chunk`. */
+static inline ulong swar_eightDigits( ulong chunk ) {
+    chunk = ((chunk & 0x0F0F0F0F0F0F0F0FUL) * (1 + (10UL << 8))) >> 8;        // adjacent digits -> 2-digit values
+    chunk = ((chunk & 0x00FF00FF00FF00FFUL) * (1 + (100UL << 16))) >> 16;     // -> 4-digit values
+    return ((chunk & 0x0000FFFF0000FFFFUL) * (1 + (10000UL << 32))) >> 32;    // -> the 8-digit value
+    }
+
+/* The value of digit-char c (in base 36, say), or UINT_MAX if c isn't a digit/letter. */
+static inline uint digitValue( char const c ) {
+    if ('0' <= c && c <= '9') return (uint)(c - '0');
+    if ('a' <= c && c <= 'z') return (uint)(c - 'a' + 10);
+    if ('A' <= c && c <= 'Z') return (uint)(c - 'A' + 10);
+    return UINT_MAX;
+    }
+
+/* Read the base-`base` digits in [s,end) as an unsigned magnitude, stopping at the first non-digit;
+ * set *stop to there.
+ * Return 0, or EINVAL if there were no digits at all, or ERANGE if the magnitude exceeds ULONG_MAX
+ * (in which case all the digits are still consumed).
+ */
+static int parseMagnitude( const char* s, const char* const end, uint const base, ulong* mag, const char** stop ) {
+    const char* const start = s;
+    ulong acc = 0;
+    bool overflow = false;
+    if (base != 10) {
+        uint d;
+        while (s < end && (d = digitValue(*s)) < base) {
+            overflow = overflow
+                       || __builtin_mul_overflow(acc, (ulong)base, &acc)
+                       || __builtin_add_overflow(acc, (ulong)d, &acc);
+            ++s;
+            }
+        *stop = s;
+        *mag = acc;
+        if (s == start) return EINVAL;
+        return overflow ? ERANGE : 0;
+        }
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // acc < 10^11 guarantees acc*10^8 + 99999999 still fits in a ulong.
+    while (end - s >= 8 && acc < 100000000000UL) {
+        ulong chunk;
+        memcpy(&chunk, s, 8);
+        if (!swar_allDigits(chunk)) break;
+        acc = acc*100000000UL + swar_eightDigits(chunk);
+        s += 8;
+        }
+#endif
+    while (s < end && '0' <= *s && *s <= '9') {
+        overflow = overflow
+                   || __builtin_mul_overflow(acc, 10UL, &acc)
+                   || __builtin_add_overflow(acc, (ulong)(*s - '0'), &acc);
+        ++s;
+        }
+    *stop = s;
+    *mag = acc;
+    if (s == start) return EINVAL;
+    return overflow ? ERANGE : 0;
+    }
+
+/* Read an optional '+'/'-' at *s; return whether it was '-'. */
+static bool parseSign( const char** s, const char* const end ) {
+    if (*s < end && (**s == '+' || **s == '-')) { return *(*s)++ == '-'; }
+    return false;
+    }
+
+/* Shared by all the parse_* functions:  sign, magnitude, and the check against [-maxNeg, maxPos].
+ * Base 0 means, as for strtol:  hex after a "0x" (or "0X"), octal after a leading "0", else decimal.
+ */
+static int parseSigned( const char* s, const char* end, uint base, ulong const maxPos, ulong const maxNeg,
+                        ulong* mag, bool* isNeg, const char** stop ) {
+    if (end == NULL) end = s + strlen(s);
+    const char* const start = s;
+    *isNeg = parseSign(&s, end);
+    if (base == 0) {
+        if (end - s >= 3 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X') && digitValue(s[2]) < 16) { base = 16;  s += 2; }
+        else if (s < end && s[0] == '0') base = 8;
+        else base = 10;
+        }
+    int status = parseMagnitude(s, end, base, mag, stop);
+    if (status == EINVAL) { *stop = start; return EINVAL; }
+    if (status == 0 && *mag > (*isNeg ? maxNeg : maxPos)) status = ERANGE;
+    return status;
+    }
+
+#define MAKE_PARSE_FUNC_BODY(typ,maxPos,maxNeg) \
+( const char* s, const char* end, typ* out, const char** stop ) { \
+    ulong mag; \
+    bool isNeg; \
+    const char* ignoredStop; \
+    if (stop == NULL) stop = &ignoredStop; \
+    int const status = parseSigned(s, end, 10, (maxPos), (maxNeg), &mag, &isNeg, stop); \
+    if (status == 0) *out = isNeg  ?  (typ)(0UL - mag)  :  (typ)mag; \
+    return status; \
+    }
+
+int parse_i  MAKE_PARSE_FUNC_BODY(int,   (ulong)INT_MAX,  (ulong)INT_MAX+1)
+int parse_u  MAKE_PARSE_FUNC_BODY(uint,  (ulong)UINT_MAX, 0UL)
+int parse_l  MAKE_PARSE_FUNC_BODY(long,  (ulong)LONG_MAX, (ulong)LONG_MAX+1)
+int parse_ul MAKE_PARSE_FUNC_BODY(ulong, ULONG_MAX,       0UL)
+
+
+static const char* skipSpace( const char* s, const char* const end ) {
+    while (s < end && isspace((uchar)*s)) ++s;
+    return s;
+    }
+
+/* Parse all of `s` (allowing surrounding whitespace, but nothing else) in base 0, or exit. */
+#define MAKE_OR_DIE_FUNC_BODY(typ,maxPos,maxNeg,funcName,rangeFmt,lo,hi) \
+( stringConst valAsStr, stringConst valRepresents ) { \
+    const char* const end = valAsStr + strlen(valAsStr); \
+    const char* stop; \
+    ulong mag; \
+    bool isNeg; \
+    int status = parseSigned( skipSpace(valAsStr, end), end, 0, (maxPos), (maxNeg), &mag, &isNeg, &stop ); \
+    if (status == 0 && skipSpace(stop, end) != end) status = EINVAL; \
+    if (status == EINVAL) { fprintf(stderr, "%s: %s is invalid: \"%s\" is not a numeral.\n", funcName, valRepresents, valAsStr); exit(EINVAL); } \
+    if (status == ERANGE) { fprintf(stderr, "%s: %s must be in [" rangeFmt "," rangeFmt "]; got \"%s\".\n", funcName, valRepresents, lo, hi, valAsStr); exit(ERANGE); } \
+    return isNeg  ?  (typ)(0UL - mag)  :  (typ)mag; \
+    }
+
+/* Convert a string to a uint.  Exit if string isn't a valid uint, with `valRepresents` used in the error message. 
+ * Exit with the EINVAL or ERANGE.
+ */
+uint strtou_or_die MAKE_OR_DIE_FUNC_BODY(uint, (ulong)UINT_MAX, 0UL, "strtou_or_die", "%u", 0u, UINT_MAX)
+
+/* Convert a string to an int.  Exit if string isn't a valid int, with `valRepresents` used in the error message. 
+ * Exit with the EINVAL or ERANGE.
+ */
+int strtoi_or_die MAKE_OR_DIE_FUNC_BODY(int, (ulong)INT_MAX, (ulong)INT_MAX+1, "strtoi_or_die", "%i", INT_MIN, INT_MAX)
+
+
+/* Parse the numerals in buf[0,len) into out[], in order.
+ * Numerals are separated by `delim` and/or whitespace (at least one of them); leading/trailing
+ * whitespace and one trailing `delim` are fine.
+ */
+long parseArrayI( const char* const buf, size_t const len, char const delim, int* out ) {
+    const char* const end = buf + len;
+    const char* s = skipSpace(buf, end);
+    long n = 0;
+    while (s < end) {
+        const char* stop;
+        int const status = parse_i(s, end, &out[n], &stop);
+        if (status != 0) { errno = status; return -1; }
+        ++n;
+        s = skipSpace(stop, end);
+        if (s < end && *s == delim && !isspace((uchar)delim)) { s = skipSpace(s+1, end); }
+        else if (s == stop && s < end) { errno = EINVAL; return -1; }  // e.g. "3hi": no separator after the numeral.
+        }
+    return n;
+    }
+
+
+/* String views. */
+
+int strview_compare( strview a, strview b ) {
+    size_t const n = MIN(a.len, b.len);
+    int const cmp = (n == 0)  ?  0  :  memcmp(a.s, b.s, n);
+    if (cmp != 0) return cmp;
+    return (a.len < b.len)  ?  -1  :  (a.len > b.len);
+    }
+
+bool strview_startsWith( strview v, strview prefix ) {
+    return prefix.len <= v.len  &&  strview_eq( strview_of(v.s, prefix.len), prefix );
+    }
+bool strview_endsWith( strview v, strview suffix ) {
+    return suffix.len <= v.len  &&  strview_eq( strview_of(v.s + v.len - suffix.len, suffix.len), suffix );
+    }
+
+/* glibc's memchr already checks 16-64 bytes per step (SSE2/AVX2/EVEX, chosen for this CPU);
+ * a hand-rolled AVX2 loop measured about 30% slower than it on long views, and no faster on short ones.
+ */
+long strview_findChar( strview v, char c ) {
+    if (v.len == 0) return -1;
+    const char* const at = memchr(v.s, c, v.len);
+    return (at == NULL)  ?  -1  :  at - v.s;
+    }
+
+/* Find the needle's first char, then check the rest of it there. */
+long strview_find( strview v, strview needle ) {
+    if (needle.len == 0) return 0;
+    if (needle.len > v.len) return -1;
+    size_t const lastStart = v.len - needle.len;
+    size_t i = 0;
+    while (i <= lastStart) {
+        long const at = strview_findChar( strview_sub(v, i, lastStart+1), needle.s[0] );
+        if (at < 0) return -1;
+        i += (size_t)at;
+        if (memcmp(v.s + i + 1, needle.s + 1, needle.len - 1) == 0) return (long)i;
+        ++i;
+        }
+    return -1;
+    }
+
+bool strview_nextField( strviewSplit* sp, strview* field ) {
+    if (sp->done) return false;
+    long const at = strview_findChar(sp->rest, sp->delim);
+    if (at < 0) {
+        *field = sp->rest;
+        sp->done = true;
+        }
+    else {
+        *field = strview_sub(sp->rest, 0, (size_t)at);
+        sp->rest = strview_sub(sp->rest, (size_t)at + 1, sp->rest.len);
+        }
+    return true;
+    }
+
+/* The numeral must be all of v:  no leftover chars after it. */
+#define MAKE_STRVIEW_TO_FUNC_BODY(typ,parseFunc) \
+( strview v, typ* out ) { \
+    if (v.len == 0) return EINVAL; \
+    const char* const end = v.s + v.len; \
+    const char* stop; \
+    typ val = 0; \
+    int const status = parseFunc(v.s, end, &val, &stop); \
+    if (status == EINVAL || stop != end) return EINVAL; \
+    if (status == 0) *out = val; \
+    return status; \
+    }
+
+int strview_to_int  MAKE_STRVIEW_TO_FUNC_BODY(int,  parse_i)
+int strview_to_long MAKE_STRVIEW_TO_FUNC_BODY(long, parse_l)
+
+
+/* Filling:  replicate the value into a 32-byte pattern, then store the pattern over and over --
+ * with AVX2 if this CPU has it (checked once), else SSE2, else plain memcpy.
+ * For fills much bigger than the cache, use non-temporal (streaming) stores, which skip reading
+ * each destination line into the cache first, only to evict it again.
+ */
+#define FILL_PATTERN_SIZE 32
+#define FILL_SMALL_BYTES 128   // fills smaller than this just use a plain loop
+
+size_t fill_streamingBytes = 0;
+
+static void fillPattern_scalar( char* dst, size_t const nBytes, const char* pattern ) {
+    size_t i = 0;
+    for (;  i + FILL_PATTERN_SIZE <= nBytes;  i += FILL_PATTERN_SIZE) { memcpy(dst+i, pattern, FILL_PATTERN_SIZE); }
+    memcpy(dst+i, pattern, nBytes-i);
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+__attribute__((target("sse2")))
+static void fillPattern_sse2( char* dst, size_t const nBytes, const char* pattern ) {
+    __m128i const v = _mm_loadu_si128( (const __m128i*)pattern );  // (the pattern repeats every 16 bytes, too)
+    size_t i = 0;
+    for (;  i + 64 <= nBytes;  i += 64) {
+        _mm_storeu_si128( (__m128i*)(dst+i),    v );
+        _mm_storeu_si128( (__m128i*)(dst+i+16), v );
+        _mm_storeu_si128( (__m128i*)(dst+i+32), v );
+        _mm_storeu_si128( (__m128i*)(dst+i+48), v );
+        }
+    for (;  i + 16 <= nBytes;  i += 16) { _mm_storeu_si128( (__m128i*)(dst+i), v ); }
+    memcpy(dst+i, pattern, nBytes-i);
+    }
+
+__attribute__((target("avx2")))
+static void fillPattern_avx2( char* dst, size_t const nBytes, const char* pattern ) {
+    __m256i const v = _mm256_loadu_si256( (const __m256i*)pattern );
+    size_t i = 0;
+    size_t const streamingBytes = (fill_streamingBytes != 0)  ?  fill_streamingBytes  :  cpu.cacheBytes;
+    if (nBytes >= streamingBytes) {
+        // Streaming stores need 32-byte-aligned addresses.  Fill up to the first one normally;
+        // since the pattern repeats every element, and 32 is a multiple of the element size, we can keep
+        // using the same pattern (rotated by however far we got).
+        size_t const head = (size_t)(-(uintptr_t)dst & 31);
+        _mm256_storeu_si256( (__m256i*)dst, v );
+        char rotated[2*FILL_PATTERN_SIZE];
+        memcpy(rotated, pattern, FILL_PATTERN_SIZE);
+        memcpy(rotated+FILL_PATTERN_SIZE, pattern, FILL_PATTERN_SIZE);
+        __m256i const vAligned = _mm256_loadu_si256( (const __m256i*)(rotated + head) );
+        for (i = head;  i + 128 <= nBytes;  i += 128) {
+            _mm256_stream_si256( (__m256i*)(dst+i),    vAligned );
+            _mm256_stream_si256( (__m256i*)(dst+i+32), vAligned );
+            _mm256_stream_si256( (__m256i*)(dst+i+64), vAligned );
+            _mm256_stream_si256( (__m256i*)(dst+i+96), vAligned );
+            }
+        _mm_sfence();
+        for (;  i + 32 <= nBytes;  i += 32) { _mm256_storeu_si256( (__m256i*)(dst+i), vAligned ); }
+        memcpy(dst+i, rotated+head, nBytes-i);
+        return;
+        }
+    for (;  i + 128 <= nBytes;  i += 128) {
+        _mm256_storeu_si256( (__m256i*)(dst+i),    v );
+        _mm256_storeu_si256( (__m256i*)(dst+i+32), v );
+        _mm256_storeu_si256( (__m256i*)(dst+i+64), v );
+        _mm256_storeu_si256( (__m256i*)(dst+i+96), v );
+        }
+    for (;  i + 32 <= nBytes;  i += 32) { _mm256_storeu_si256( (__m256i*)(dst+i), v ); }
+    memcpy(dst+i, pattern, nBytes-i);
+    }
+#endif
+
+typedef void (*fillPatternFunc)( char* dst, size_t const nBytes, const char* pattern );
+
+static fillPatternFunc chooseFillPattern() {
+    pthread_once(&cpuOnce, initCpu);
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpu.avx2) return fillPattern_avx2;
+    if (cpu.sse2) return fillPattern_sse2;
+#endif
+    return fillPattern_scalar;
+    }
+
+/* Fill dst[0,nBytes) by repeating the `eltSize` bytes at `elt`.  (eltSize must divide FILL_PATTERN_SIZE.) */
+static void fillRepeating( void* dst, size_t const nBytes, const void* elt, size_t const eltSize ) {
+    fillPatternFunc const fillPattern = chooseFillPattern();
+    char pattern[FILL_PATTERN_SIZE];
+    for (size_t k=0;  k<FILL_PATTERN_SIZE;  k += eltSize) { memcpy(pattern+k, elt, eltSize); }
+    fillPattern( (char*)dst, nBytes, pattern );
+    }
+
+
+/* Uniform random values of each type, in [lo,hi). */
+static inline char randIn_C( rngState* rng, char const lo, char const hi ) {
+    return (char)(lo + (int)rng_below(rng, (uint)(hi - lo)));
+    }
+static inline long randIn_Li( rngState* rng, long const lo, long const hi ) {
+    // Lemire's reduction again, but with 64-bit halves of a 128-bit product.
+    ulong const bound = (ulong)hi - (ulong)lo;
+    unsigned __int128 m = (unsigned __int128)rng_next(rng) * bound;
+    if ((ulong)m < bound) {
+        ulong const threshold = (0UL - bound) % bound;
+        while ((ulong)m < threshold) { m = (unsigned __int128)rng_next(rng) * bound; }
+        }
+    return (long)((ulong)lo + (ulong)(m >> 64));
+    }
+/* For floating-point: the top 24 (or 53) bits make a uniform fraction in [0,1) (exactly representable),
+ * scaled into [lo,hi) -- falling back to lo if rounding would land exactly on hi.
+ */
+static inline float randIn_F( rngState* rng, float const lo, float const hi ) {
+    float const r = lo + (hi - lo) * ((float)(rng_next(rng) >> 40) * 0x1.0p-24f);
+    return (r < hi)  ?  r  :  lo;
+    }
+static inline double randIn_Lf( rngState* rng, double const lo, double const hi ) {
+    double const r = lo + (hi - lo) * ((double)(rng_next(rng) >> 11) * 0x1.0p-53);
+    return (r < hi)  ?  r  :  lo;
+    }
+
+
+/* The allocation/fill family, for each element type. */
+#define MAKE_ARRAY_FUNCS(suffix,typ) \
+typ* newArray##suffix##_uninit( uint sz ) { \
+    assert(sz>0); \
+    typ* arr = (typ*) malloc(sz*sizeof(typ)); \
+    assert (arr!=NULL); \
+    return arr; \
+    } \
+typ* newArray##suffix##_aligned( uint sz, size_t alignment ) { \
+    assert(sz>0); \
+    void* arr = NULL; \
+    int const err = posix_memalign( &arr, (alignment==0 ? ARRAY_ALIGNMENT : alignment), sz*sizeof(typ) ); \
+    assert(err==0); \
+    return (typ*) arr; \
+    } \
+typ* fillArray##suffix( typ* arr, uint sz, typ val ) { \
+    if (sz*sizeof(typ) < FILL_SMALL_BYTES) { for (uint i=0;  i<sz;  ++i) { arr[i] = val; } } \
+    else { fillRepeating( arr, sz*sizeof(typ), &val, sizeof(typ) ); } \
+    return arr; \
+    } \
+typ* newArray##suffix( uint sz, typ val ) { return fillArray##suffix(newArray##suffix##_uninit(sz), sz, val); }
+
+#define MAKE_RAND_ARRAY_FUNCS(suffix,typ) \
+typ* fillArray##suffix##_rand( typ* arr, uint sz, typ lo, typ hi ) { \
+    assert(lo < hi); \
+    rngState* const rng = rng_default(); \
+    for (uint i=0;  i<sz;  ++i) { arr[i] = randIn_##suffix(rng, lo, hi); } \
+    return arr; \
+    } \
+typ* newArray##suffix##_rand( uint sz, typ lo, typ hi ) { return fillArray##suffix##_rand(newArray##suffix##_uninit(sz), sz, lo, hi); }
+
+MAKE_ARRAY_FUNCS(B,bool)
+MAKE_ARRAY_FUNCS(C,char)
+MAKE_ARRAY_FUNCS(I,int)
+MAKE_ARRAY_FUNCS(F,float)
+MAKE_ARRAY_FUNCS(Li,long)
+MAKE_ARRAY_FUNCS(Lf,double)
+
+MAKE_RAND_ARRAY_FUNCS(C,char)
+MAKE_RAND_ARRAY_FUNCS(F,float)
+MAKE_RAND_ARRAY_FUNCS(Li,long)
+MAKE_RAND_ARRAY_FUNCS(Lf,double)
+
+#define MAKE_ARENA_ARRAY_FUNCS(suffix,typ) \
+typ* newArray##suffix##_uninit_arena( arena* a, uint sz ) { return ARENA_ALLOC_ARRAY(a, sz, typ); } \
+typ* newArray##suffix##_arena( arena* a, uint sz, typ val ) { \
+    return fillArray##suffix( newArray##suffix##_uninit_arena(a, sz), sz, val ); \
     }
+MAKE_ARENA_ARRAY_FUNCS(B,bool)
+MAKE_ARENA_ARRAY_FUNCS(C,char)
+MAKE_ARENA_ARRAY_FUNCS(I,int)
+MAKE_ARENA_ARRAY_FUNCS(F,float)
+MAKE_ARENA_ARRAY_FUNCS(Li,long)
+MAKE_ARENA_ARRAY_FUNCS(Lf,double)
+
+// For ints, rng_fillI gets two values per draw.
 int* fillArrayI_rand( int* arr, uint sz, int lo, int hi ) { 
-    for (uint i=0;  i<sz;  ++i) { arr[i] = lo + random()%(hi-lo); } 
-    return arr;
+    return rng_fillI( rng_default(), arr, sz, lo, hi );
     }
-int* newArrayI( uint sz, int val ) { return fillArrayI(newArrayI_uninit(sz), sz, val); }
 int* newArrayI_rand( uint sz, int lo, int hi ) { return fillArrayI_rand(newArrayI_uninit(sz), sz, lo, hi); }
 
+// For bools, a fair coin-flip; each draw supplies 64 of them.
+bool* fillArrayB_rand( bool* arr, uint sz ) {
+    rngState* const rng = rng_default();
+    for (uint i=0;  i<sz;  i += 64) {
+        ulong const bits = rng_next(rng);
+        for (uint k=0;  k<64 && i+k<sz;  ++k) { arr[i+k] = (bits >> k) & 1; }
+        }
+    return arr;
+    }
+bool* newArrayB_rand( uint sz ) { return fillArrayB_rand(newArrayB_uninit(sz), sz); }
+
+
+
+/* Pseudo-random numbers:  xoshiro256** (Blackman & Vigna, https://prng.di.unimi.it/),
+ * seeded via splitmix64 so that any 64-bit seed (even 0) gives a well-mixed state.
+ * Ranges use Lemire's multiply-shift reduction ("Fast Random Integer Generation in an Interval", 2019):
+ * take the high half of x*bound, and reject the rare x's that would make the result biased.
+ */
+static inline ulong rotl64( ulong const x, int const k ) { return (x << k) | (x >> (64 - k)); }
+
+static ulong splitmix64( ulong* state ) {
+    ulong z = (*state += 0x9E3779B97F4A7C15UL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9UL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBUL;
+    return z ^ (z >> 31);
+    }
+
+void rng_seed( rngState* rng, ulong seed ) {
+    for (int i=0;  i<4;  ++i) { rng->s[i] = splitmix64(&seed); }
+    }
+
+ulong rng_next( rngState* rng ) {
+    ulong* const s = rng->s;
+    ulong const result = rotl64(s[1] * 5, 7) * 9;
+    ulong const t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl64(s[3], 45);
+    return result;
+    }
+
+/* Reduce the 32 random bits `x` into [0,bound), or return false if x must be rejected. */
+static inline bool lemireReduce( uint const x, uint const bound, uint* result ) {
+    ulong const m = (ulong)x * (ulong)bound;
+    uint const low = (uint)m;
+    if (low < bound && low < (0u - bound) % bound) return false;
+    *result = (uint)(m >> 32);
+    return true;
+    }
+
+uint rng_below( rngState* rng, uint const bound ) {
+    assert(bound > 0);
+    uint r;
+    while (!lemireReduce( (uint)(rng_next(rng) >> 32), bound, &r )) { }
+    return r;
+    }
+
+/* N.B. hi-lo is computed in unsigned arithmetic, so even [INT_MIN,INT_MAX) doesn't overflow. */
+int rng_rangeI( rngState* rng, int const lo, int const hi ) {
+    assert(lo < hi);
+    return (int)((uint)lo + rng_below(rng, (uint)hi - (uint)lo));
+    }
+
+/* Each 64-bit draw supplies two 32-bit candidates, so the generator runs half as often as there are elements. */
+int* rng_fillI( rngState* rng, int* arr, uint const sz, int const lo, int const hi ) {
+    assert(lo < hi);
+    uint const bound = (uint)hi - (uint)lo;
+    uint i = 0;
+    while (i < sz) {
+        ulong const bits = rng_next(rng);
+        uint r;
+        if (lemireReduce( (uint)(bits >> 32), bound, &r )) { arr[i++] = (int)((uint)lo + r); }
+        if (i < sz && lemireReduce( (uint)bits, bound, &r )) { arr[i++] = (int)((uint)lo + r); }
+        }
+    return arr;
+    }
+
+/* Advance `rng` by 2^128 steps, as if rng_next were called that many times (the xoshiro authors' jump polynomial).
+ * So from one seed, jumping k times gives the k'th of 2^128 non-overlapping substreams.
+ */
+void rng_jump( rngState* rng ) {
+    static const ulong JUMP[] = { 0x180ec6d33cfd0abaUL, 0xd5a61266f0c9392cUL, 0xa9582618e03fc9aaUL, 0x39abdc4529b1661cUL };
+    ulong s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i=0;  i<4;  ++i) {
+        for (int b=0;  b<64;  ++b) {
+            if (JUMP[i] & (1UL << b)) {
+                s0 ^= rng->s[0];
+                s1 ^= rng->s[1];
+                s2 ^= rng->s[2];
+                s3 ^= rng->s[3];
+                }
+            rng_next(rng);
+            }
+        }
+    rng->s[0] = s0;
+    rng->s[1] = s1;
+    rng->s[2] = s2;
+    rng->s[3] = s3;
+    }
+
+/* The thread-local default generator.  Thread #k (numbered in order of first use) starts from
+ * seed RNG_DEFAULT_SEED+k, so a single-threaded program gets the same numbers on every run.
+ */
+static _Thread_local rngState defaultRng;
+static _Thread_local bool defaultRngSeeded = false;
+static atomic_ulong defaultRngThreads = 0;
+
+rngState* rng_default() {
+    if (!defaultRngSeeded) {
+        rng_seed( &defaultRng, RNG_DEFAULT_SEED + atomic_fetch_add(&defaultRngThreads, 1UL) );
+        defaultRngSeeded = true;
+        }
+    return &defaultRng;
+    }
+
+void rng_seedDefault( ulong const seed ) {
+    rng_seed( &defaultRng, seed );
+    defaultRngSeeded = true;
+    }
+
+
+
+/* Parallel fills:
+ * The array is cut into fixed-size blocks (so, independent of the number of threads), and each thread
+ * takes a contiguous run of blocks.  For _rand, block #b gets its own substream: the seed, jumped b times.
+ * So every element's value depends only on (seed, its index), never on how the work was divided.
+ */
+#define PAR_FILL_BLOCK (1UL<<16)  // elements
+
+typedef struct {
+    int* arr;
+    ulong sz;
+    int val, lo, hi;
+    bool isRand;
+    rngState rng;        // for isRand:  the substream for block #firstBlock.
+    ulong firstBlock, endBlock;
+    } parFillChunk;
+
+static void* parFillWorker( void* arg ) {
+    parFillChunk* const c = (parFillChunk*) arg;
+    for (ulong b = c->firstBlock;  b < c->endBlock;  ++b) {
+        ulong const start = b*PAR_FILL_BLOCK;
+        uint const len = (uint) MIN(PAR_FILL_BLOCK, c->sz - start);
+        if (c->isRand) {
+            rngState blockRng = c->rng;
+            rng_fillI( &blockRng, c->arr + start, len, c->lo, c->hi );
+            rng_jump( &c->rng );
+            }
+        else {
+            fillArrayI( c->arr + start, len, c->val );
+            }
+        }
+    return NULL;
+    }
+
+static uint chooseNumThreads( uint numThreads, ulong const numBlocks ) {
+    if (numThreads == 0) {
+        long const cores = sysconf(_SC_NPROCESSORS_ONLN);
+        numThreads = (cores > 0)  ?  (uint)cores  :  1u;
+        }
+    return (uint) MAX( MIN((ulong)numThreads, numBlocks), 1UL );
+    }
+
+static int* parFill( int* arr, ulong const sz, parFillChunk const proto, ulong const seed, uint numThreads ) {
+    ulong const numBlocks = (sz + PAR_FILL_BLOCK - 1) / PAR_FILL_BLOCK;
+    numThreads = chooseNumThreads(numThreads, numBlocks);
+    parFillChunk* chunks = ALLOC_ARRAY(numThreads, parFillChunk);
+    pthread_t* threads = ALLOC_ARRAY(numThreads, pthread_t);
+    assert(chunks != NULL && threads != NULL);
+    rngState rng;
+    rng_seed(&rng, seed);
+    for (uint t=0;  t<numThreads;  ++t) {
+        chunks[t] = proto;
+        chunks[t].arr = arr;
+        chunks[t].sz = sz;
+        chunks[t].firstBlock = numBlocks *  t    / numThreads;
+        chunks[t].endBlock   = numBlocks * (t+1) / numThreads;
+        if (proto.isRand) {
+            chunks[t].rng = rng;
+            for (ulong b = chunks[t].firstBlock;  b < chunks[t].endBlock;  ++b) { rng_jump(&rng); }
+            }
+        }
+    // Thread 0's share is done by this thread.
+    for (uint t=1;  t<numThreads;  ++t) {
+        int const err = pthread_create( &threads[t], NULL, parFillWorker, &chunks[t] );
+        assert(err == 0);
+        }
+    parFillWorker(&chunks[0]);
+    for (uint t=1;  t<numThreads;  ++t) { pthread_join(threads[t], NULL); }
+    free(threads);
+    free(chunks);
+    return arr;
+    }
+
+int* fillArrayI_par( int* arr, ulong sz, int val, uint numThreads ) {
+    parFillChunk proto;
+    memset(&proto, 0, sizeof(proto));
+    proto.val = val;
+    return parFill( arr, sz, proto, 0, numThreads );
+    }
+
+int* fillArrayI_rand_par( int* arr, ulong sz, int lo, int hi, ulong seed, uint numThreads ) {
+    assert(lo < hi);
+    parFillChunk proto;
+    memset(&proto, 0, sizeof(proto));
+    proto.isRand = true;
+    proto.lo = lo;
+    proto.hi = hi;
+    return parFill( arr, sz, proto, seed, numThreads );
+    }
+
+/* malloc doesn't touch the pages; so the first write to each -- by whichever thread fills that part -- places it. */
+static int* newArrayI_untouched( ulong sz ) {
+    assert(sz>0);
+    int* arr = (int*) malloc( sz*sizeof(int) );
+    assert(arr!=NULL);
+    return arr;
+    }
+
+int* newArrayI_par( ulong sz, int val, uint numThreads ) {
+    return fillArrayI_par( newArrayI_untouched(sz), sz, val, numThreads );
+    }
+
+int* newArrayI_rand_par( ulong sz, int lo, int hi, ulong seed, uint numThreads ) {
+    return fillArrayI_rand_par( newArrayI_untouched(sz), sz, lo, hi, seed, numThreads );
+    }
+
+
+
+/* Loading numerals from a text file:
+ * mmap the file, and cut it into chunks of about fromFile_chunkBytes -- each boundary moved forward to just
+ * past a separator, so that no numeral is split between two chunks.  Then, with each thread taking a
+ * contiguous run of chunks (as for parFill), two passes:
+ *   count the numerals in each chunk;  a running total of the counts gives each chunk's first index
+ *   in the result, which can now be allocated at exactly the right size;  then
+ *   parse each chunk's numerals straight into their places.
+ * Counting is just a scan for separator-to-numeral transitions, which is cheap next to parsing.
+ */
+size_t fromFile_chunkBytes = 1UL<<20;
+
+static inline bool isFromFileSeparator( char const c ) {
+    return c == ',' || c == ' ' || ('\t' <= c && c <= '\r');
+    }
+
+typedef struct {
+    const char* start;  // the chunk's text is [start,end)
+    const char* end;
+    ulong first, count; // the index (in the result) of its first numeral;  how many numerals it has
+    int status;         // from parsing:  0, EINVAL, or ERANGE
+    } fromFileChunk;
+
+typedef struct {
+    fromFileChunk* chunks;
+    ulong firstChunk, endChunk;
+    bool counting;      // else, parsing into `out`
+    bool isDouble;
+    void* out;
+    } fromFileWork;
+
+static ulong countNumerals( const char* s, const char* const end ) {
+    ulong n = 0;
+    bool prevWasSep = true;  // (a chunk always starts at the start of the file, or just after a separator)
+    for (;  s < end;  ++s) {
+        bool const isSep = isFromFileSeparator(*s);
+        n += (ulong)(prevWasSep && !isSep);
+        prevWasSep = isSep;
+        }
+    return n;
+    }
+
+static const char* skipFromFileSeparators( const char* s, const char* const end ) {
+    while (s < end && isFromFileSeparator(*s)) ++s;
+    return s;
+    }
+
+static int parseChunkI( const char* s, const char* const end, int* out ) {
+    for (s = skipFromFileSeparators(s, end);  s < end;  s = skipFromFileSeparators(s, end)) {
+        const char* stop;
+        int const status = parse_i(s, end, out++, &stop);
+        if (status != 0) return status;
+        if (stop < end && !isFromFileSeparator(*stop)) return EINVAL;  // e.g. "3x" or "3.5"
+        s = stop;
+        }
+    return 0;
+    }
+
+/* strtod needs a null-terminated string -- which the mmapped text isn't -- so copy each numeral out first. */
+static int parseChunkLf( const char* s, const char* const end, double* out ) {
+    char numeral[FROM_FILE_MAX_NUMERAL_LEN+1];
+    for (s = skipFromFileSeparators(s, end);  s < end;  s = skipFromFileSeparators(s, end)) {
+        const char* tokenEnd = s;
+        while (tokenEnd < end && !isFromFileSeparator(*tokenEnd)) ++tokenEnd;
+        size_t const len = (size_t)(tokenEnd - s);
+        if (len > FROM_FILE_MAX_NUMERAL_LEN) return EINVAL;
+        memcpy(numeral, s, len);
+        numeral[len] = '\0';
+        char* stop;
+        errno = 0;
+        double const x = strtod(numeral, &stop);
+        if (stop != numeral + len) return EINVAL;
+        if (errno == ERANGE && isinf(x)) return ERANGE;  // (but underflowing to a subnormal or 0 is fine)
+        *out++ = x;
+        s = tokenEnd;
+        }
+    return 0;
+    }
+
+static void* fromFileWorker( void* arg ) {
+    fromFileWork* const w = (fromFileWork*) arg;
+    for (ulong k = w->firstChunk;  k < w->endChunk;  ++k) {
+        fromFileChunk* const c = &w->chunks[k];
+        if (w->counting)     c->count  = countNumerals(c->start, c->end);
+        else if (w->isDouble) c->status = parseChunkLf(c->start, c->end, (double*)w->out + c->first);
+        else                 c->status = parseChunkI( c->start, c->end, (int*)w->out    + c->first);
+        }
+    return NULL;
+    }
+
+/* Run one pass over all the chunks, split among the threads. */
+static void fromFilePass( fromFileChunk* chunks, ulong const numChunks, bool const counting, bool const isDouble, void* out ) {
+    uint const numThreads = chooseNumThreads(0, numChunks);
+    fromFileWork* work = ALLOC_ARRAY(numThreads, fromFileWork);
+    pthread_t* threads = ALLOC_ARRAY(numThreads, pthread_t);
+    assert(work != NULL && threads != NULL);
+    for (uint t=0;  t<numThreads;  ++t) {
+        work[t] = (fromFileWork){ chunks, numChunks * t / numThreads, numChunks * (t+1) / numThreads, counting, isDouble, out };
+        }
+    // Thread 0's share is done by this thread.
+    for (uint t=1;  t<numThreads;  ++t) {
+        int const err = pthread_create( &threads[t], NULL, fromFileWorker, &work[t] );
+        assert(err == 0);
+        }
+    fromFileWorker(&work[0]);
+    for (uint t=1;  t<numThreads;  ++t) { pthread_join(threads[t], NULL); }
+    free(threads);
+    free(work);
+    }
+
+static void* newArray_fromFile( stringConst path, ulong* count, size_t const eltSize, bool const isDouble ) {
+    int const fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat info;
+    if (fstat(fd, &info) != 0) { int const err = errno;  close(fd);  errno = err;  return NULL; }
+    size_t const len = (size_t)info.st_size;
+    const char* text = "";
+    void* mapped = NULL;
+    if (len > 0) {
+        mapped = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) { int const err = errno;  close(fd);  errno = err;  return NULL; }
+        madvise(mapped, len, MADV_SEQUENTIAL);  // (just a hint, to read ahead aggressively)
+        text = (const char*) mapped;
+        }
+    close(fd);  // (the mapping stays valid without it)
+
+    size_t const chunkBytes = MAX(fromFile_chunkBytes, 1UL);
+    ulong const numChunks = MAX((len + chunkBytes - 1) / chunkBytes, 1UL);
+    fromFileChunk* chunks = ALLOC_ARRAY(numChunks, fromFileChunk);
+    assert(chunks != NULL);
+    const char* const end = text + len;
+    const char* s = text;
+    for (ulong k=0;  k<numChunks;  ++k) {
+        // (If the previous chunk's numeral ran past this one's nominal boundary, this chunk starts later -- or is empty.)
+        const char* boundary = (k+1 == numChunks)  ?  end  :  MAX(s, text + (k+1)*chunkBytes);
+        while (boundary < end && !isFromFileSeparator(*boundary)) ++boundary;
+        chunks[k].start = s;
+        chunks[k].end = boundary;
+        s = boundary;
+        }
+
+    fromFilePass( chunks, numChunks, true, isDouble, NULL );
+    ulong total = 0;
+    for (ulong k=0;  k<numChunks;  ++k) {
+        chunks[k].first = total;
+        total += chunks[k].count;
+        }
+    void* out = malloc( MAX(total, 1UL) * eltSize );
+    assert(out != NULL);
+    fromFilePass( chunks, numChunks, false, isDouble, out );
+
+    int status = 0;
+    for (ulong k=0;  k<numChunks && status==0;  ++k) { status = chunks[k].status; }
+    free(chunks);
+    if (mapped != NULL) munmap(mapped, len);
+    if (status != 0) {
+        free(out);
+        errno = status;
+        return NULL;
+        }
+    *count = total;
+    return out;
+    }
+
+int* newArrayI_fromFile( stringConst path, ulong* count ) {
+    return (int*) newArray_fromFile( path, count, sizeof(int), false );
+    }
+double* newArrayLf_fromFile( stringConst path, ulong* count ) {
+    return (double*) newArray_fromFile( path, count, sizeof(double), true );
+    }
+
+
+
+/* Growable arrays (see DECLARE_VEC in the .h). */
+DEFINE_VEC(B,bool)
+DEFINE_VEC(C,char)
+DEFINE_VEC(I,int)
+DEFINE_VEC(F,float)
+DEFINE_VEC(Li,long)
+DEFINE_VEC(Lf,double)
+
+#define MAKE_VEC_TOSTRING(suffix) \
+char* vec##suffix##_toString( const vec##suffix* v, \
+                              stringConst open, stringConst formatSpec, stringConst between, stringConst close ) { \
+    assert(v->len <= INT_MAX); \
+    return arr##suffix##_toNewString( v->data, (int)v->len, open, formatSpec, between, close ); \
+    }
+MAKE_VEC_TOSTRING(B)
+MAKE_VEC_TOSTRING(C)
+MAKE_VEC_TOSTRING(I)
+MAKE_VEC_TOSTRING(F)
+MAKE_VEC_TOSTRING(Li)
+MAKE_VEC_TOSTRING(Lf)
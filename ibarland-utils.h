@@ -8,6 +8,10 @@
  *   ALLOC_ARRAY
  *   DPRINTF      (N.B. To enable debugging, `#define DEBUG` in a file BEFORE `#include`ing this .h.)
  *   SIZEOF_ARRAY (N.B. good only for local, stack-allocated arrays, not pointers)
+ *   arena, ARENA_ALLOC, ARENA_ALLOC_ARRAY  (bump-allocation; see arena_init, arena_alloc, arena_mark/rewind, arena_reset)
+ *   pool, POOL_DEFINE, POOL_ALLOC, POOL_FREE  (same-size objects;  see pool_init, pool_alloc, pool_free, pool_stats)
+ *   internTable  (canonical copies of strings;  see intern, intern_lookup, streq_interned)
+ *   strview, STRVIEW_ARG  (a slice of a string, not null-terminated;  see strview_find, strview_split, strview_to_int)
  *   stringConst
  *   uint  // TODO: remove; use uint -- more C-ish
  *    byte
@@ -33,16 +37,23 @@
  *
  *   strtou_or_die
  *   strtoi_or_die
+ *   parse_i, parse_u, parse_l, parse_ul  (report errors rather than exiting)
+ *   parseArrayI
  *   
  * Functions/constants provided:
  *    sgn
  *    modPos
  *    lmodPos
+ *    moddiv_init, modPos_by, modPosArr, modPosArr_by  (modPos by a precomputed divisor)
  *    M_TAU     = 2*M_PI
  *    degToRad
  *    radToDeg
+ *    fmodPos, angleNormalize, angleNormalizeSigned
+ *    degToRadArr, radToDegArr, angleNormalizeArr, angleNormalizeSignedArr  (and ...ArrF, for floats)
+ *    sinArr, cosArr, sincosArr, atan2Arr  (and ...ArrF;  at a chosen trigAccuracy)
  *    isinfinite
- *    approxEquals
+ *    approxEquals, approxEqualsRel, approxEqualsArrD, approxEqualsArrF
+ *    ulpDistance, ulpDistanceF, approxEqualsUlps, ulpDistanceArr, ulpDistanceArrF, printUlpHistogram
  * 
  *    streq
  *    strdiff
@@ -51,8 +62,17 @@
  *    intToString    (N.B. Caller must free the returned-string.)
  *    uintToString   (N.B. Caller must free the returned-string.)
  *    longToString   (N.B. Caller must free the returned-string.)
+ *    ulongToString  (N.B. Caller must free the returned-string.)
+ *    intToString_into, uintToString_into, longToString_into, ulongToString_into  (write into a caller's buffer)
+ *    newStrCat_arena, intToString_arena, ..., sb_finish_arena, newArrayX_arena  (allocate from an arena; no free needed)
+ *    arrI_toNumerals, arrLi_toNumerals  (many numerals in one buffer)
+ *    numDigits_u, numDigits_ul
+ *
+ *    strBuilder     (a growable string; see sb_init, sb_append, sb_appendf, sb_reserve, sb_finish)
  *    
  *    time_usec
+ *    time_nsec, time_nsec_coarse  (monotonic)
+ *    cycles_now, cycles_now_ordered, cyclesToNsec, cycles_perNsec, calibrateCycles
  *
  *    arrB_toString
  *    arrC_toString
@@ -60,17 +80,36 @@
  *    arrF_toString
  *    arrLi_toString
  *    arrLf_toString
+ *    arrB_write, arrC_write, arrI_write, arrF_write, arrLi_write, arrLf_write  (stream to a FILE*)
+ *    arrB_writeFd, arrC_writeFd, ...                                             (stream to a file-descriptor)
+ *    saveArrayX, mapArrayX, unmapArray  (binary array files;  loading is just mmapping)
+ *    
+ *    newArrayX_uninit, newArrayX_aligned, newArrayX, newArrayX_rand, fillArrayX, fillArrayX_rand
+ *      (for X = B,C,I,F,Li,Lf)
+ *    newArrayI_par, fillArrayI_par, newArrayI_rand_par, fillArrayI_rand_par  (multi-threaded)
+ *    newArrayI_fromFile, newArrayLf_fromFile  (numerals from a text file; mmapped, multi-threaded)
+ *
+ *    vecX  (growable arrays: vecX_init, _push, _pop, _reserve, _insert, _erase, _shrink, _free, _toString)
+ *    DECLARE_VEC, DEFINE_VEC  (vectors of other types)
+ *    DECLARE_HASHMAP, DEFINE_HASHMAP  (hash maps, for any key/value types);  strHash, strnHash, ulongHash
  *    
  *    testStr
  *    testChar
  *    testUInt
  *    testInt
  *    testBool
+ *    testDoubleArray, testFloatArray
  *    printTestMsg
  *    printTestSummary
  *    resetTestSummary
+ *    TEST_CASE, runTestCases  (named groups of tests, run in parallel)
+ *
+ *    BENCH, DO_NOT_OPTIMIZE, runAllBenches  (micro-benchmarks; see ibarland-utils-bench.c)
+ *
+ *    rngState, rng_seed, rng_next, rng_below, rng_rangeI, rng_fillI, rng_default  (pseudo-random numbers)
  *
  *    pid_t forkAndExec( stringConst cmd );
+ *    spawnProcess, spawnOptions_init  (start a process without fork, with argv/envp and redirections)
  */
 
 
@@ -92,6 +131,14 @@
 #include <stdbool.h> // for testBool
 #include <unistd.h> // for pid_t
 #include <stdio.h>  // for fprintf
+#include <stddef.h> // for size_t
+#include <assert.h> // for vecX_pop
+#include <stdint.h> // for uintptr_t
+#include <pthread.h> // for pool's lock
+#include <string.h> // for strview_eq
+#ifndef __cplusplus
+#include <stdalign.h> // for alignof  (built in, in C++)
+#endif
 
 typedef const char * const stringConst;
 
@@ -114,6 +161,185 @@ typedef unsigned long long   ulonglong;
  */
 
 
+/* Arenas (a.k.a. regions):  allocate many small things cheaply, then release them all at once.
+ *    arena a;
+ *    arena_init(&a, 0);
+ *    char* s = newStrCat_arena(&a, "x=", intToString_arena(&a, x));   // no free() for either
+ *    ...
+ *    arena_reset(&a);   // everything allocated so far is gone; `a` is ready for re-use.
+ *    ...
+ *    arena_free(&a);    // when done with the arena itself.
+ * Allocation just bumps a pointer within the current chunk (ARENA_DEFAULT_CHUNK bytes, unless arena_init says otherwise);
+ * when that's used up, a new chunk is started.  Requests too big for a chunk get a chunk of their own.
+ * Nothing is ever freed individually.  arena_mark/arena_rewind release only what was allocated since the mark
+ * (marks must be rewound in last-in-first-out order).
+ * reset and rewind keep the released chunks for re-use (so a steady-state loop of alloc..reset doesn't malloc),
+ * and take time proportional to the number of chunks released, not the number of allocations.
+ * An arena is not thread-safe; use one per thread.
+ */
+#define ARENA_DEFAULT_CHUNK ((size_t)64*1024)
+#define ARENA_ALIGNMENT alignof(max_align_t)  // what arena_alloc guarantees (as malloc does)
+
+struct arenaChunk;
+typedef struct {
+    char* next;  // the next free byte, in the current chunk
+    char* end;   // the end of the current chunk
+    struct arenaChunk* chunk;  // the current chunk (each points to the one before it)
+    struct arenaChunk* first;
+    struct arenaChunk* spare;  // released chunks, for re-use
+    size_t chunkSize;
+    } arena;
+typedef struct { struct arenaChunk* chunk;  char* next; } arenaMark;
+
+/* Set up an empty arena, whose chunks will be chunkSize bytes (0 for ARENA_DEFAULT_CHUNK). */
+void  arena_init( arena* a, size_t chunkSize );
+/* Release all of a's memory (including its chunks); a must be re-init'd before any further use. */
+void  arena_free( arena* a );
+/* Release everything allocated from a, so far. */
+void  arena_reset( arena* a );
+arenaMark arena_mark( const arena* a );
+/* Release everything allocated from a since `m` was taken. */
+void  arena_rewind( arena* a, arenaMark m );
+
+void* arena_allocSlow( arena* a, size_t size, size_t alignment );  // (arena_allocAligned's slow path)
+/* Return `size` uninitialized bytes, starting at a multiple of `alignment` (a power of 2). */
+static inline void* arena_allocAligned( arena* a, size_t size, size_t alignment ) {
+    size_t const padding = (size_t)(-(uintptr_t)a->next) & (alignment-1);
+    size_t const room = (size_t)(a->end - a->next);
+    if (padding > room  ||  size > room - padding) {
+        return arena_allocSlow(a, size, alignment);
+        }
+    char* const p = a->next + padding;
+    a->next = p + size;
+    return p;
+    }
+static inline void* arena_alloc( arena* a, size_t size ) { return arena_allocAligned(a, size, ARENA_ALIGNMENT); }
+#define ARENA_ALLOC(a, typ)              (typ *) (arena_allocAligned((a), sizeof(typ), alignof(typ)))
+#define ARENA_ALLOC_ARRAY(a, n, typ)     (typ *) (arena_allocAligned((a), (size_t)(n)*sizeof(typ), alignof(typ)))  // N.B. uninitialized.
+
+
+/* Pools:  for allocating (and freeing) many objects all of one size, faster than malloc/free.
+ * For a (single-word) type name `typ`:
+ *    POOL_DECLARE(node)     // in a header, if other files need it
+ *    POOL_DEFINE(node)      // in one .c file:  defines (and, before main runs, inits) the pool `pool_node`
+ *    node* n = POOL_ALLOC(node);    // like ALLOC(node) -- uninitialized
+ *    POOL_FREE(node, n);            // like free(n)
+ * (Or make your own pools with pool_init/pool_alloc/pool_free/pool_destroy.)
+ *
+ * Objects are carved from big slabs (which are only released by pool_destroy).  A freed object is kept on a free
+ * list threaded through the objects themselves.  Each thread keeps its own cache of free objects for each pool,
+ * so the usual alloc and free take no lock;  objects move between a thread's cache and the shared pool in
+ * batches of POOL_BATCH.  (So an object may be freed by a different thread than allocated it.)
+ * A thread's cached objects are returned to the pool when the thread exits.
+ *
+ * pool_stats reports (approximately -- other threads' counts are folded in only once per batch) how many
+ * allocations there were, and how many of those came straight from a thread's cache (the hit-rate).
+ */
+#define POOL_BATCH 32
+#define POOL_CACHE_SLOTS 16   // per thread:  pools beyond this many (in use by one thread) evict each other's caches
+
+typedef struct { ulong allocs, cacheHits, frees, refills, flushes, slabs;  size_t slabBytes; } poolStats;
+
+typedef struct pool {
+    size_t objSize;  // as allocated:  at least two pointers' worth, and a multiple of `align`
+    size_t align;
+    ulong  epoch;    // distinct for every pool_init ever (so a stale cache never matches);  0 once destroyed
+    pthread_mutex_t lock;  // for all the following
+    void*  batches;  // free objects returned by threads:  chains of them, each chain's first object linking to the next chain
+    char*  slabNext; // the un-carved part of the newest slab
+    char*  slabEnd;
+    void*  slabs;
+    poolStats stats;
+    struct pool* nextLive;
+    } pool;
+
+/* One thread's cache for one pool (internal, but pool_alloc/pool_free inline their fast paths). */
+typedef struct {
+    ulong  epoch;    // of the pool being cached (0: none)
+    pool*  owner;
+    void*  head;
+    uint   count;
+    ulong  hits, misses, frees;  // not yet added into owner->stats
+    } poolCache;
+#ifdef __cplusplus
+extern thread_local poolCache poolCaches[POOL_CACHE_SLOTS];
+#else
+extern _Thread_local poolCache poolCaches[POOL_CACHE_SLOTS];
+#endif
+
+/* Set up a pool of objects of `objSize` bytes, each aligned to `align` (a power of 2). */
+void  pool_init( pool* p, size_t objSize, size_t align );
+/* Release all of p's memory -- including any objects not yet freed.  No thread may use p during or after this
+ * (unless p is pool_init'd again).
+ */
+void  pool_destroy( pool* p );
+void* pool_allocSlow( pool* p );
+void  pool_freeSlow( pool* p, void* obj );
+poolStats pool_stats( pool* p );
+/* Print a one-line summary of `s`, including the cache hit-rate. */
+void  printPoolStats( FILE* f, stringConst name, poolStats const s );
+
+static inline void* pool_alloc( pool* p ) {
+    poolCache* const c = &poolCaches[p->epoch % POOL_CACHE_SLOTS];
+    void* const obj = c->head;
+    if (c->epoch != p->epoch  ||  obj == NULL) return pool_allocSlow(p);
+    c->head = *(void**)obj;
+    --c->count;
+    ++c->hits;
+    return obj;
+    }
+static inline void pool_free( pool* p, void* obj ) {
+    if (obj == NULL) return;
+    poolCache* const c = &poolCaches[p->epoch % POOL_CACHE_SLOTS];
+    if (c->epoch != p->epoch  ||  c->count >= 2*POOL_BATCH) { pool_freeSlow(p, obj);  return; }
+    *(void**)obj = c->head;
+    c->head = obj;
+    ++c->count;
+    ++c->frees;
+    }
+
+#define POOL_DECLARE(typ)  extern pool pool_##typ;
+#define POOL_DEFINE(typ) \
+    pool pool_##typ; \
+    __attribute__((constructor)) static void poolInit_##typ() { pool_init(&pool_##typ, sizeof(typ), alignof(typ)); }
+#define POOL_ALLOC(typ)       (typ *) (pool_alloc(&pool_##typ))
+#define POOL_FREE(typ, obj)   pool_free(&pool_##typ, (obj))
+
+
+/* Interned strings:  one canonical copy of each distinct string, so that comparing two interned strings
+ * is just comparing pointers (streq_interned), rather than strcmp'ing them.
+ *    stringConst a = intern("--size");
+ *    stringConst b = intern(argv[i]);
+ *    if (streq_interned(a,b)) ...              // same chars (iff same pointer)
+ *    stringConst c = intern_lookup(argv[i]);   // NULL, if nobody has interned that string (and don't add it)
+ * intern, internn, and intern_lookup use one process-wide table, whose strings last until the program exits.
+ * Or, make separate tables (internTable_new), whose strings live in an arena of your choosing
+ * and so go away with it (or with internTable_free, if the table has its own arena).
+ * Thread-safe:  lookups take no lock (and don't write to shared memory), yet always find a string that
+ * any thread has finished interning;  only adding a new string takes the table's lock.
+ */
+typedef struct internTable internTable;  // (its innards are in ibarland-utils.c)
+
+/* A new, empty table, keeping its strings in `strings` (or if NULL, in an arena of its own). */
+internTable* internTable_new( arena* strings );
+/* Release the table (and its own arena, if it has one -- in which case its interned strings are gone too). */
+void internTable_free( internTable* t );
+/* Return the canonical copy of s (adding it, if need be). */
+stringConst internTable_intern( internTable* t, stringConst s );
+stringConst internTable_internn( internTable* t, const char* s, size_t len );  // of s[0,len)
+/* Return the canonical copy of s, or NULL if s hasn't been interned. */
+stringConst internTable_lookup( internTable* t, stringConst s );
+stringConst internTable_lookupn( internTable* t, const char* s, size_t len );
+/* How many distinct strings t holds. */
+size_t internTable_count( internTable* t );
+
+stringConst intern( stringConst s );
+stringConst internn( const char* s, size_t len );
+stringConst intern_lookup( stringConst s );
+/* Are two *interned* strings the same?  (For strings in general, use streq.) */
+static inline bool streq_interned( stringConst a, stringConst b ) { return a == b; }
+
+
 
 #define MIN(X,Y)  (((X) <= (Y)) ? (X) : (Y))
 #define MAX(X,Y)  (((X) >= (Y)) ? (X) : (Y))
@@ -138,6 +364,29 @@ uint strtou_or_die( stringConst valAsStr, stringConst valRepresents );
  * Exit with the EINVAL or ERANGE.
  */
 int strtoi_or_die( stringConst valAsStr, stringConst valRepresents );
+/* (Both of the above accept a numeral as strtol does with base 0 -- decimal; or hex after "0x"; or octal
+ * after a leading "0" -- optionally signed and surrounded by whitespace.  "3hi", "3.9", "09", and "" are all invalid.)
+ */
+
+/* Parse a decimal numeral (an optional '+' or '-', then digits) starting exactly at `s`,
+ * reading no further than `end` (or if `end` is NULL, to the terminating null).
+ * Return 0 on success, storing the value into *out;
+ *   EINVAL if there are no digits at `s` (*out is untouched);
+ *   ERANGE if the value doesn't fit the type (*out is untouched).
+ * If `stop` is non-NULL, set *stop to just past the last digit read (for EINVAL, to `s`).
+ * These never exit, print, allocate, or set errno.
+ */
+int parse_i(  const char* s, const char* end, int*   out, const char** stop );
+int parse_u(  const char* s, const char* end, uint*  out, const char** stop );
+int parse_l(  const char* s, const char* end, long*  out, const char** stop );
+int parse_ul( const char* s, const char* end, ulong* out, const char** stop );
+
+/* Parse the ints in buf[0,len) -- separated by `delim` and/or whitespace -- into out[0], out[1], ... .
+ * Return how many were parsed, or -1 (with errno EINVAL or ERANGE) if some entry is malformed.
+ * `out` needs room for (len+1)/2 ints, which is always enough.
+ * E.g.   parseArrayI("3, -4,5\n", 8, ',', out)  returns 3, with out = {3,-4,5}.
+ */
+long parseArrayI( const char* const buf, size_t const len, char const delim, int* out );
 
 /* 'signum', the sign of a number (+1, 0, or -1). */
 float sgn( long double const x );
@@ -146,16 +395,104 @@ float sgn( long double const x );
 int   modPos( int const n,  int const b );
 long lmodPos( long const n, long const b );
 
+/* For taking many `modPos(n,b)` with the same b, without any division:
+ *     moddiv_t byTen;
+ *     moddiv_init( &byTen, 10 );
+ *     modPos_by( -13, &byTen )   // 7, same as modPos(-13,10)
+ * modPosArr does a whole array (out may be the same array as ns).
+ */
+typedef struct {
+    ulong M;           // ceil(2^64 / |b|)
+    uint absB;
+    uint offsetMod;    // 2^31 mod |b|
+    int b;
+    } moddiv_t;
+void moddiv_init( moddiv_t* div, int const b );
+int  modPos_by( int const n, const moddiv_t* div );
+void modPosArr(    const int* ns, ulong const sz, int const b, int* out );
+void modPosArr_by( const int* ns, ulong const sz, const moddiv_t* div, int* out );
+
 /* a-b, with a floor of 0.  Helpful for both signed & unsigned arithmetic. */
 int monus( int a, int b );
 uint monus_u( uint a, uint b );
 
 
-extern double M_TAU;  // tau = 2*pi
+// tau = 2*pi.  (Named like math.h's M_PI, though math.h doesn't have it.)
+#define M_TAU 6.28318530717958647692528676655900577
 double degToRad(double const theta);
 double radToDeg(double const theta);
+/* Like modPos, for doubles:  the result has the sign of b (e.g. in [0,b) for positive b). */
+double fmodPos( double const x, double const b );
+/* An equivalent angle, in [0, M_TAU)  (or for angleNormalizeSigned, in (-M_PI, M_PI]). */
+double angleNormalize(       double const theta );
+double angleNormalizeSigned( double const theta );
+/* Whole arrays of the above:  out[i] = f(thetas[i]) for i<sz, vectorized.  (out may be thetas itself.) */
+void degToRadArr(  const double* thetas, ulong const sz, double* out );
+void degToRadArrF( const float*  thetas, ulong const sz, float*  out );
+void radToDegArr(  const double* thetas, ulong const sz, double* out );
+void radToDegArrF( const float*  thetas, ulong const sz, float*  out );
+void angleNormalizeArr(        const double* thetas, ulong const sz, double* out );
+void angleNormalizeArrF(       const float*  thetas, ulong const sz, float*  out );
+void angleNormalizeSignedArr(  const double* thetas, ulong const sz, double* out );
+void angleNormalizeSignedArrF( const float*  thetas, ulong const sz, float*  out );
+
+/* sin, cos, sin-and-cos, and atan2, over whole arrays (vectorized):  out[i] = f(xs[i])  (or f(ys[i],xs[i])).
+ * Choose, per call, how accurate:
+ *   TRIG_FAST     within about 1e-3  (absolute)
+ *   TRIG_MEDIUM   within about 1e-6  (absolute)
+ *   TRIG_FULL     within a few ulps of libm
+ * Large angles (|x| above a million, or 8192 for floats) fall back to libm.  out may be xs itself.
+ */
+typedef enum { TRIG_FAST, TRIG_MEDIUM, TRIG_FULL } trigAccuracy;
+void sinArr(    const double* xs, ulong const sz, double* out, trigAccuracy const acc );
+void cosArr(    const double* xs, ulong const sz, double* out, trigAccuracy const acc );
+void sincosArr( const double* xs, ulong const sz, double* sins, double* coss, trigAccuracy const acc );
+void atan2Arr(  const double* ys, const double* xs, ulong const sz, double* out, trigAccuracy const acc );
+void sinArrF(    const float* xs, ulong const sz, float* out, trigAccuracy const acc );
+void cosArrF(    const float* xs, ulong const sz, float* out, trigAccuracy const acc );
+void sincosArrF( const float* xs, ulong const sz, float* sins, float* coss, trigAccuracy const acc );
+void atan2ArrF(  const float* ys, const float* xs, ulong const sz, float* out, trigAccuracy const acc );
 bool isinfinite( double x );
 bool approxEquals(double const x, double const y);
+/* Are x,y within absoluteTolerance of each other, or within relativeTolerance (a fraction of the larger)? */
+bool approxEqualsRel(double x, double y, double relativeTolerance, double absoluteTolerance);
+
+/* How many representable doubles (floats) apart are x and y?  E.g. ulpDistance(1.0, nextafter(1.0,2.0)) == 1.
+ * -0.0 and +0.0 are 0 apart;  the largest finite value is 1 away from infinity.
+ * If either is NaN, return the maximum (ULONG_MAX / UINT_MAX).  Branch-free.
+ */
+ulong ulpDistance(  double const x, double const y );
+uint  ulpDistanceF( float  const x, float  const y );
+/* Are x,y (neither NaN) within maxUlps representable doubles of each other? */
+bool approxEqualsUlps( double const x, double const y, ulong const maxUlps );
+
+/* A histogram of ulp errors:  counts[0] is how many were exact, counts[1] how many were off by 1,
+ * and counts[k] for k>1, how many were in (4^(k-2), 4^(k-1)] -- that is, buckets 0, 1, 2-4, 5-16, 17-64, ....
+ * (NaNs land in the last bucket.)
+ * ulpBucketLow/High give each bucket's (inclusive) range.
+ */
+#define ULP_HISTOGRAM_BUCKETS 34
+typedef struct {
+    ulong counts[ULP_HISTOGRAM_BUCKETS];
+    ulong total;
+    ulong maxUlps;
+    } ulpHistogram;
+void  ulpHistogram_init( ulpHistogram* hist );
+ulong ulpBucketLow(  uint const bucket );
+ulong ulpBucketHigh( uint const bucket );
+void  printUlpHistogram( FILE* out, const ulpHistogram* hist );
+/* dists[i] = ulpDistance(xs[i],ys[i]), for each i<sz;  and/or add them all to hist.
+ * Either dists or hist (but not both) may be NULL.  hist accumulates, across calls.
+ */
+void ulpDistanceArr(  const double* xs, const double* ys, ulong sz, ulong* dists, ulpHistogram* hist );
+void ulpDistanceArrF( const float*  xs, const float*  ys, ulong sz, uint*  dists, ulpHistogram* hist );
+
+/* Compare two arrays element-by-element, as approxEqualsRel (vectorized, where the CPU allows).
+ * Return how many elements differ, and the index of the first (or -1, if none).
+ */
+typedef struct { ulong count;  long first; } arrMismatches;
+arrMismatches approxEqualsArrD( const double* xs, const double* ys, ulong sz, double relTol, double absTol );
+arrMismatches approxEqualsArrF( const float*  xs, const float*  ys, ulong sz, double relTol, double absTol );
 
 // string-equal and string-different -- using `strcmp` in boolean expressions goofs me up otherwise.
 bool streq( stringConst s1, stringConst s2 );
@@ -182,6 +519,126 @@ char* uintToString( uint const n );
  * The string is heap-allocated; IT IS THE CALLER'S RESPONSIBILITY TO FREE THE STRING when done with it.
  */
 char* longToString( long const n );
+/* Return a string numeral, for the given ulong.
+ * The string is heap-allocated; IT IS THE CALLER'S RESPONSIBILITY TO FREE THE STRING when done with it.
+ */
+char* ulongToString( ulong const n );
+
+/* Like newStrCat, intToString, etc., but the string is allocated from the arena `a` (so: NOT to be freed). */
+char* newStrCat_arena(     arena* a, stringConst strA, stringConst strB );
+char* intToString_arena(   arena* a, int const n );
+char* uintToString_arena(  arena* a, uint const n );
+char* longToString_arena(  arena* a, long const n );
+char* ulongToString_arena( arena* a, ulong const n );
+
+/* Write the numeral for `n` into buf[0,cap), null-terminated, with no allocation.
+ * Return the numeral's length (not counting the null).
+ * Like snprintf: if the numeral+null doesn't fit in `cap` chars, nothing is written, but
+ * the needed length is still returned -- so `..._into(n,NULL,0)` just measures.
+ * (INT_TO_STRING_MAX_LEN is a buffer-size that always suffices, for any of these.)
+ */
+#define INT_TO_STRING_MAX_LEN 21   // 20 digits of ULONG_MAX (or 19 digits of LONG_MIN, plus '-'), and a null.
+size_t   intToString_into(   int const n, char* buf, size_t cap );
+size_t  uintToString_into(  uint const n, char* buf, size_t cap );
+size_t  longToString_into(  long const n, char* buf, size_t cap );
+size_t ulongToString_into( ulong const n, char* buf, size_t cap );
+
+/* The number of decimal digits in n (so, 1 for n==0). */
+uint numDigits_u( uint const n );
+uint numDigits_ul( ulong const n );
+
+/* Format each of arr[0..sz-1] as a numeral, all into one (exactly-sized) buffer.
+ * offsets[0..sz] gets filled in: numeral #i is the null-terminated string at buf+offsets[i],
+ * and offsets[sz] is the total size of buf.  (So `offsets` must have room for sz+1 entries.)
+ * The buffer is heap-allocated; IT IS THE CALLER'S RESPONSIBILITY TO FREE IT when done with it.
+ */
+char* arrI_toNumerals(  const int*  const arr, size_t const sz, size_t* offsets );
+char* arrLi_toNumerals( const long* const arr, size_t const sz, size_t* offsets );
+
+
+/* String views:  a slice s[0,len) of some other buffer -- NOT null-terminated, and not owned
+ * (so there's nothing to free, and the view is good only as long as the underlying buffer is).
+ * Views let us pick apart a big buffer (a log line, an mmapped file) without copying any of it:
+ *    strview line = strview_of(buf, len);
+ *    strviewSplit fields = strview_split(line, ',');
+ *    strview field;
+ *    while (strview_nextField(&fields, &field)) {
+ *        int n;
+ *        if (strview_to_int(field, &n) == 0) ...
+ *        else printf("bad field: \"%.*s\"\n", STRVIEW_ARG(field));
+ *        }
+ */
+typedef struct { const char* s;  size_t len; } strview;
+#define STRVIEW_ARG(v)  (int)(v).len, (v).s   // for printf's "%.*s"
+
+static inline strview strview_of( const char* s, size_t len ) { return (strview){ s, len }; }
+static inline strview strview_fromStr( stringConst s ) { return (strview){ s, strlen(s) }; }
+/* The view v[from,to).  Requires from <= to <= v.len. */
+static inline strview strview_sub( strview v, size_t from, size_t to ) {
+    assert(from <= to && to <= v.len);
+    return (strview){ v.s + from, to - from };
+    }
+
+static inline bool strview_eq( strview a, strview b ) { return a.len == b.len  &&  (a.len == 0 || memcmp(a.s, b.s, a.len) == 0); }
+/* Like strcmp:  negative, zero, or positive as a is before, the same as, or after b (comparing as unsigned chars). */
+int  strview_compare(    strview a, strview b );
+bool strview_startsWith( strview v, strview prefix );
+bool strview_endsWith(   strview v, strview suffix );
+
+/* The index of the first c (or needle) in v, or -1 if there is none.
+ * strview_findChar is memchr, so it checks 16-32 bytes at a time (SSE2/AVX2).
+ */
+long strview_findChar( strview v, char c );
+long strview_find(     strview v, strview needle );
+
+/* Iterate over the fields of v separated by `delim`, left to right.
+ * Every delimiter separates two fields, so "a,,b" has three fields (the middle one empty),
+ * a trailing delimiter makes a final empty field, and "" is one empty field.
+ */
+typedef struct { strview rest;  char delim;  bool done; } strviewSplit;
+static inline strviewSplit strview_split( strview v, char delim ) { return (strviewSplit){ v, delim, false }; }
+/* Set *field to the next field and return true, or return false if there are no more. */
+bool strview_nextField( strviewSplit* sp, strview* field );
+
+/* Parse all of v as a decimal numeral (an optional '+' or '-', then digits -- no whitespace or other chars).
+ * Return 0 on success, storing the value into *out; else EINVAL or ERANGE, with *out untouched (as parse_i).
+ */
+int strview_to_int(  strview v, int*  out );
+int strview_to_long( strview v, long* out );
+
+
+
+/* A growable string, for building up a result piece-by-piece
+ * without re-copying everything-so-far on each append (as repeated newStrCat would).
+ * Capacity doubles as needed, so n appends cost O(total length), amortized.
+ * Usage:
+ *    strBuilder sb;
+ *    sb_init(&sb);
+ *    sb_append(&sb, "x=");
+ *    sb_appendf(&sb, "%i", x);
+ *    char* result = sb_finish(&sb);  // IT IS THE CALLER'S RESPONSIBILITY TO FREE result.
+ * A strBuilder holds no shared/static state, so different threads may use different builders freely.
+ */
+typedef struct {
+    char*  str;  // always null-terminated (once anything has been reserved/appended)
+    size_t len;  // strlen(str)
+    size_t cap;  // bytes allocated for str, including room for the terminating null
+    } strBuilder;
+
+void  sb_init( strBuilder* sb );
+/* Make sure there is room for at least `extra` more chars (beyond the current length). */
+void  sb_reserve( strBuilder* sb, size_t extra );
+void  sb_append( strBuilder* sb, stringConst s );
+void  sb_appendn( strBuilder* sb, const char* s, size_t n );  // append the first n chars of s
+void  sb_appendf( strBuilder* sb, stringConst fmt, ... ) __attribute__ ((format (printf, 2, 3)));
+/* Return the built string (trimmed to size), and reset `sb` to empty.
+ * The string is heap-allocated; IT IS THE CALLER'S RESPONSIBILITY TO FREE THE STRING when done with it.
+ */
+char* sb_finish( strBuilder* sb );
+/* Discard the contents of `sb`, freeing its storage. */
+void  sb_free( strBuilder* sb );
+/* Like sb_finish, but the result is copied into the arena `a` (and sb's own storage is freed). */
+char* sb_finish_arena( strBuilder* sb, arena* a );
 
 
 
@@ -210,33 +667,450 @@ stringConst arrLf_toString( const double* const arr, const int sz,
                             stringConst open, stringConst formatSpec, stringConst between, stringConst close );
 
 
-/** Return an array of `sz` ints (sz>0), uninitialized.
- * It is the responsibility of the caller to free this memory.
+/* Like arrX_toString (with the same open/formatSpec/between/close conventions),
+ * but write the text to `f` (or for the `_writeFd` versions, to the file-descriptor `fd`)
+ * rather than building it in memory.  The text is formatted into a fixed-size
+ * buffer which is flushed each time it fills, so memory-use doesn't grow with `sz`.
+ * Return the number of bytes written, or -1 if a write failed (with errno set).
  */
-int* newArrayI_uninit( uint sz );
+#define DECLARE_WRITE_ARR_FUNCS(suffix,typ) \
+long arr##suffix##_write(   FILE* f, const typ* const arr, const int sz, \
+                            stringConst open, stringConst formatSpec, stringConst between, stringConst close ); \
+long arr##suffix##_writeFd( int fd,  const typ* const arr, const int sz, \
+                            stringConst open, stringConst formatSpec, stringConst between, stringConst close );
+DECLARE_WRITE_ARR_FUNCS(B,bool)
+DECLARE_WRITE_ARR_FUNCS(C,char)
+DECLARE_WRITE_ARR_FUNCS(I,int)
+DECLARE_WRITE_ARR_FUNCS(F,float)
+DECLARE_WRITE_ARR_FUNCS(Li,long int)
+DECLARE_WRITE_ARR_FUNCS(Lf,double)
 
 
-/** Return an array of `sz` ints (sz>0), initialized to `val`. 
- * It is the responsibility of the caller to free this memory.
+/* Binary array files:  exact (unlike "%f"), as compact as the array itself, and loadable without parsing.
+ * A file is a small header -- magic number, format version, element type and size, count, byte-order --
+ * padded to 64 bytes, followed by the elements' raw bytes.  With X and T as for newArrayX:
+ *
+ * long saveArrayX( stringConst path, const T* arr, ulong sz )
+ *     Write arr[0,sz) to the file `path` (replacing it, if it exists).  The replacement is all-or-nothing:
+ *     the new file is written alongside and then renamed over `path`, so a failed save leaves the old file
+ *     intact, and any current mapping of the old file still sees its old contents.
+ *     Return the number of bytes written, or -1 if opening/writing failed (with errno set).
+ * const T* mapArrayX( stringConst path, ulong* sz )
+ *     Return the array saved in `path`, setting *sz to its size.  The file is mmapped, so nothing is
+ *     read or copied up front:  each page is faulted in when first used.  The array starts 64-byte-aligned.
+ *     It is read-only, and valid until passed to unmapArray (NOT free).
+ *     Return NULL with errno set if the file can't be opened or mapped;  EINVAL if it isn't an array file
+ *     of T's, or was saved on a machine with the other byte-order, or by an incompatible version.
+ * void unmapArray( const void* arr )
+ *     Release an array from mapArrayX (of any type).
  */
-int* newArrayI( uint sz, int val );
-
-/** Return an array of `sz` ints (sz>0), initialized with random values in [lo,hi), where hi>lo.
- * It is the responsibility of the caller to free this memory.
- * Result depends on, and changes, the state of `random`.
+#define DECLARE_ARRAY_FILE_FUNCS(suffix,typ) \
+long       saveArray##suffix( stringConst path, const typ* arr, ulong sz ); \
+const typ* mapArray##suffix(  stringConst path, ulong* sz );
+DECLARE_ARRAY_FILE_FUNCS(B,bool)
+DECLARE_ARRAY_FILE_FUNCS(C,char)
+DECLARE_ARRAY_FILE_FUNCS(I,int)
+DECLARE_ARRAY_FILE_FUNCS(F,float)
+DECLARE_ARRAY_FILE_FUNCS(Li,long)
+DECLARE_ARRAY_FILE_FUNCS(Lf,double)
+void unmapArray( const void* arr );
+
+
+/* Arrays, for each element type (suffix B,C,I,F,Li,Lf -- bool, char, int, float, long, double -- as for arrX_toString).
+ * With X and T standing for the suffix and type:
+ *
+ * T* newArrayX_uninit( uint sz )
+ *     Return an array of `sz` Ts (sz>0), uninitialized.
+ * T* newArrayX_aligned( uint sz, size_t alignment )
+ *     Return an array of `sz` Ts (sz>0), uninitialized, starting at a multiple of `alignment`
+ *     (a power of 2, at least sizeof(void*); or 0 for ARRAY_ALIGNMENT -- a cache-line, and a multiple of any vector width).
+ * T* newArrayX( uint sz, T val )
+ *     Return an array of `sz` Ts (sz>0), initialized to `val`.
+ * T* newArrayX_rand( uint sz, T lo, T hi )
+ *     Return an array of `sz` Ts (sz>0), initialized with random values in [lo,hi), where hi>lo.
+ *     (For bool, there is no lo,hi: true and false are equally likely.)
+ *     Result depends on, and changes, the state of this thread's rng_default().
+ * All of the above: It is the responsibility of the caller to free this memory (with `free`, even if aligned).
+ *
+ * T* fillArrayX( T* arr, uint sz, T val )
+ *     Fill arr[0,sz) with `val`.  Returns `arr` as a convenience.
+ *     (Uses vector stores -- AVX2 if the CPU has it -- and for large arrays, bypasses the cache.)
+ * T* fillArrayX_rand( T* arr, uint sz, T lo, T hi )
+ *     Fill arr[0,sz) with values random from [lo,hi), where hi>lo.  Returns `arr`, as a convenience.
+ *     (Again, bool has no lo,hi.)
+ *     Result depends on, and changes, the state of this thread's rng_default().
  */
-int* newArrayI_rand( uint sz, int lo, int hi );
-
-
-/* Fill arr[0,sz) with `val`.  Returns `arr` as a convenience. */
-int* fillArrayI( int* arr, uint sz, int val );
+#define ARRAY_ALIGNMENT 64
+/* fillArrayX of at least this many bytes bypasses the cache (since it'd just be evicting everything else anyway).
+ * 0 (the default) means: the size of the last-level cache.
+ */
+extern size_t fill_streamingBytes;
+
+#define DECLARE_ARRAY_FUNCS(suffix,typ) \
+typ* newArray##suffix##_uninit( uint sz ); \
+typ* newArray##suffix##_aligned( uint sz, size_t alignment ); \
+typ* newArray##suffix( uint sz, typ val ); \
+typ* fillArray##suffix( typ* arr, uint sz, typ val );
+#define DECLARE_RAND_ARRAY_FUNCS(suffix,typ) \
+typ* newArray##suffix##_rand( uint sz, typ lo, typ hi ); \
+typ* fillArray##suffix##_rand( typ* arr, uint sz, typ lo, typ hi );
+
+DECLARE_ARRAY_FUNCS(B,bool)
+DECLARE_ARRAY_FUNCS(C,char)
+DECLARE_ARRAY_FUNCS(I,int)
+DECLARE_ARRAY_FUNCS(F,float)
+DECLARE_ARRAY_FUNCS(Li,long)
+DECLARE_ARRAY_FUNCS(Lf,double)
+
+DECLARE_RAND_ARRAY_FUNCS(C,char)
+DECLARE_RAND_ARRAY_FUNCS(I,int)
+DECLARE_RAND_ARRAY_FUNCS(F,float)
+DECLARE_RAND_ARRAY_FUNCS(Li,long)
+DECLARE_RAND_ARRAY_FUNCS(Lf,double)
+bool* newArrayB_rand( uint sz );
+bool* fillArrayB_rand( bool* arr, uint sz );
+
+/* newArrayX_uninit and newArrayX, but allocated from the arena `a` (so: NOT to be freed). */
+#define DECLARE_ARENA_ARRAY_FUNCS(suffix,typ) \
+typ* newArray##suffix##_uninit_arena( arena* a, uint sz ); \
+typ* newArray##suffix##_arena( arena* a, uint sz, typ val );
+DECLARE_ARENA_ARRAY_FUNCS(B,bool)
+DECLARE_ARENA_ARRAY_FUNCS(C,char)
+DECLARE_ARENA_ARRAY_FUNCS(I,int)
+DECLARE_ARENA_ARRAY_FUNCS(F,float)
+DECLARE_ARENA_ARRAY_FUNCS(Li,long)
+DECLARE_ARENA_ARRAY_FUNCS(Lf,double)
+
+
+/* Pseudo-random numbers (xoshiro256**): fast, not cryptographic.
+ * Each rngState is an independent stream; nothing here takes a lock or touches `random`'s state.
+ *    rngState rng;
+ *    rng_seed(&rng, 42);                  // the same seed always gives the same sequence.
+ *    int die = rng_rangeI(&rng, 1, 7);
+ * rng_default() is a per-thread generator, seeded with RNG_DEFAULT_SEED (plus the thread's number,
+ * in order of first use); so, reproducible run-to-run unless you rng_seedDefault from (say) time_nsec().
+ */
+typedef struct { ulong s[4]; } rngState;
+
+#define RNG_DEFAULT_SEED 0x1BA27A4DUL
+
+void  rng_seed( rngState* rng, ulong seed );
+ulong rng_next( rngState* rng );                          // 64 random bits
+uint  rng_below( rngState* rng, uint const bound );       // uniform in [0,bound), bound>0 (no modulo-bias)
+int   rng_rangeI( rngState* rng, int const lo, int const hi );  // uniform in [lo,hi), lo<hi
+/* Fill arr[0,sz) uniformly from [lo,hi), lo<hi.  Returns `arr`, as a convenience. */
+int*  rng_fillI( rngState* rng, int* arr, uint const sz, int const lo, int const hi );
+rngState* rng_default();
+void  rng_seedDefault( ulong const seed );
+/* Advance by 2^128 draws.  Jumping a freshly-seeded rng k times gives the k'th of many non-overlapping streams. */
+void  rng_jump( rngState* rng );
+
+
+/* Multi-threaded versions of newArrayI, newArrayI_rand, fillArrayI, fillArrayI_rand,
+ * for arrays of (up to) billions of ints.  `numThreads` of 0 means one per core.
+ * The _rand versions take an explicit seed; the result depends only on the seed (and sz,lo,hi) --
+ * not on numThreads, nor on rng_default() (which is untouched).
+ * The newArray versions let each thread be the first to touch its part of the array,
+ * so (on a NUMA machine) those pages are placed near the thread that initialized them.
+ */
+int* newArrayI_par(  ulong sz, int val, uint numThreads );
+int* fillArrayI_par( int* arr, ulong sz, int val, uint numThreads );
+int* newArrayI_rand_par(  ulong sz, int lo, int hi, ulong seed, uint numThreads );
+int* fillArrayI_rand_par( int* arr, ulong sz, int lo, int hi, ulong seed, uint numThreads );
+
+
+/* Read a text file of numerals -- separated by any mix of whitespace and commas -- into a new array,
+ * setting *count to how many there were.  E.g. a file "3, -4,5\n17\n" gives [3,-4,5,17].
+ * The file is mmapped and parsed in chunks, by one thread per core;  each number is parsed straight
+ * into its place in the result (no per-thread arrays to copy together afterwards).
+ * Return NULL with errno set if the file can't be read (as by open/mmap),
+ * or is malformed:  EINVAL if some entry isn't a numeral, ERANGE if its value doesn't fit the type.
+ * Ints are as parse_i reads them;  doubles as strtod does (so "1e-3", "0x1p4", "inf", "nan" are all fine),
+ * each at most FROM_FILE_MAX_NUMERAL_LEN chars.
+ * The array is heap-allocated (and non-NULL, even for zero numbers);
+ * IT IS THE CALLER'S RESPONSIBILITY TO FREE IT when done with it.
+ */
+int*    newArrayI_fromFile(  stringConst path, ulong* count );
+double* newArrayLf_fromFile( stringConst path, ulong* count );
+#define FROM_FILE_MAX_NUMERAL_LEN 127
+/* The size of the chunks the file is cut into (default 1MiB);  each thread takes a run of whole chunks. */
+extern size_t fromFile_chunkBytes;
 
 
-/* Fill arr[0,sz) with values random from [lo,hi).
- * Returns `arr`, as a convenience.
- * Result depends on, and changes, the state of `random`.
+/* Growable arrays ("vectors"), for each element type (vecB, vecC, vecI, vecF, vecLi, vecLf -- as for arrX_toString).
+ * With X and T standing for the suffix and type:
+ *
+ *    vecI squares;
+ *    vecI_init(&squares);
+ *    for (int i=0;  i<n;  ++i) { vecI_push(&squares, i*i); }
+ *    ... squares.data[0], ..., squares.data[squares.len-1] ...
+ *    vecI_free(&squares);
+ *
+ * void vecX_init( vecX* v )                       Make v empty.  (Needed before any other use.)
+ * void vecX_free( vecX* v )                       Release v's storage;  v is left empty (and still usable).
+ * void vecX_reserve( vecX* v, size_t extra )      Make room for at least `extra` more elements, beyond v->len.
+ * void vecX_push( vecX* v, T x )                  Append x.
+ * T    vecX_pop( vecX* v )                        Remove and return the last element (v->len > 0).
+ * void vecX_insert( vecX* v, size_t i, T x )      Insert x before v->data[i] (i <= v->len), shifting the rest up.
+ * void vecX_erase( vecX* v, size_t i, size_t n )  Remove v->data[i,i+n), shifting the rest down.
+ * void vecX_shrink( vecX* v )                     Give back any unused capacity.
+ * char* vecX_toString( const vecX* v, open, formatSpec, between, close )
+ *                                                 As arrX_toString, of v->data[0,v->len).  The caller must free it.
+ *
+ * Capacity (at least) doubles as needed, so n pushes cost O(n) in all, amortized.
+ * The first few elements (VEC_SMALL_BYTES worth) live inside the vecX itself, so short vectors never malloc.
+ * Since v->data may point into v itself:  don't copy a vecX by value (pass pointers to it instead),
+ * and don't hold onto v->data across a push/insert/reserve/shrink.
+ *
+ * For vectors of some other type, put `DECLARE_VEC(Pt, struct point)` in a header,
+ * and `DEFINE_VEC(Pt, struct point)` in exactly one .c file.  (There's no vecX_toString for those.)
+ */
+#define VEC_SMALL_BYTES 32
+#define VEC_SMALL_CAP(typ)  (sizeof(typ) <= VEC_SMALL_BYTES  ?  VEC_SMALL_BYTES/sizeof(typ)  :  1)
+
+#define DECLARE_VEC(suffix,typ) \
+typedef struct { \
+    typ*   data;  /* v->small, or heap-allocated */ \
+    size_t len; \
+    size_t cap; \
+    typ    small[VEC_SMALL_CAP(typ)]; \
+    } vec##suffix; \
+void vec##suffix##_init( vec##suffix* v ); \
+void vec##suffix##_free( vec##suffix* v ); \
+void vec##suffix##_grow( vec##suffix* v, size_t extra );  /* (vecX_reserve's slow path) */ \
+void vec##suffix##_insert( vec##suffix* v, size_t i, typ x ); \
+void vec##suffix##_erase( vec##suffix* v, size_t i, size_t n ); \
+void vec##suffix##_shrink( vec##suffix* v ); \
+static inline void vec##suffix##_reserve( vec##suffix* v, size_t extra ) { \
+    if (extra > v->cap - v->len) vec##suffix##_grow(v, extra); \
+    } \
+static inline void vec##suffix##_push( vec##suffix* v, typ x ) { \
+    if (v->len == v->cap) vec##suffix##_grow(v, 1); \
+    v->data[v->len++] = x; \
+    } \
+static inline typ vec##suffix##_pop( vec##suffix* v ) { \
+    assert(v->len > 0); \
+    return v->data[--v->len]; \
+    }
+
+/* The (non-inline) bodies for DECLARE_VEC's functions.  Needs <stdlib.h> and <string.h>. */
+#define DEFINE_VEC(suffix,typ) \
+void vec##suffix##_init( vec##suffix* v ) { \
+    v->data = v->small; \
+    v->len = 0; \
+    v->cap = SIZEOF_ARRAY(v->small); \
+    } \
+void vec##suffix##_free( vec##suffix* v ) { \
+    if (v->data != v->small) free(v->data); \
+    vec##suffix##_init(v); \
+    } \
+void vec##suffix##_grow( vec##suffix* v, size_t extra ) { \
+    size_t const needed = v->len + extra; \
+    assert(needed >= v->len);  /* (no overflow) */ \
+    if (needed <= v->cap) return; \
+    size_t const newCap = MAX(2*v->cap, needed); \
+    typ* newData; \
+    if (v->data == v->small) { \
+        newData = (typ*) malloc( newCap*sizeof(typ) ); \
+        assert(newData != NULL); \
+        memcpy( newData, v->small, v->len*sizeof(typ) ); \
+        } \
+    else { \
+        newData = (typ*) realloc( v->data, newCap*sizeof(typ) ); \
+        assert(newData != NULL); \
+        } \
+    v->data = newData; \
+    v->cap = newCap; \
+    } \
+void vec##suffix##_insert( vec##suffix* v, size_t i, typ x ) { \
+    assert(i <= v->len); \
+    vec##suffix##_reserve(v, 1); \
+    memmove( v->data+i+1, v->data+i, (v->len-i)*sizeof(typ) ); \
+    v->data[i] = x; \
+    ++v->len; \
+    } \
+void vec##suffix##_erase( vec##suffix* v, size_t i, size_t n ) { \
+    assert(i <= v->len  &&  n <= v->len - i); \
+    memmove( v->data+i, v->data+i+n, (v->len-i-n)*sizeof(typ) ); \
+    v->len -= n; \
+    } \
+void vec##suffix##_shrink( vec##suffix* v ) { \
+    if (v->data == v->small  ||  v->len == v->cap) return; \
+    if (v->len <= SIZEOF_ARRAY(v->small)) { \
+        memcpy( v->small, v->data, v->len*sizeof(typ) ); \
+        free(v->data); \
+        v->data = v->small; \
+        v->cap = SIZEOF_ARRAY(v->small); \
+        } \
+    else { \
+        typ* const newData = (typ*) realloc( v->data, v->len*sizeof(typ) ); \
+        assert(newData != NULL); \
+        v->data = newData; \
+        v->cap = v->len; \
+        } \
+    }
+
+#define DECLARE_VEC_TOSTRING(suffix) \
+char* vec##suffix##_toString( const vec##suffix* v, \
+                              stringConst open, stringConst formatSpec, stringConst between, stringConst close );
+
+DECLARE_VEC(B,bool)
+DECLARE_VEC(C,char)
+DECLARE_VEC(I,int)
+DECLARE_VEC(F,float)
+DECLARE_VEC(Li,long)
+DECLARE_VEC(Lf,double)
+DECLARE_VEC_TOSTRING(B)
+DECLARE_VEC_TOSTRING(C)
+DECLARE_VEC_TOSTRING(I)
+DECLARE_VEC_TOSTRING(F)
+DECLARE_VEC_TOSTRING(Li)
+DECLARE_VEC_TOSTRING(Lf)
+
+
+/* Hash functions:  fast (8 bytes at a time), well-mixed, and NOT cryptographic. */
+ulong strHash( stringConst s );
+ulong strnHash( const char* s, size_t len );  // of s[0,len)
+ulong ulongHash( ulong n );
+
+
+/* Hash maps (open addressing, with Robin Hood probing), generated for a key-type K and value-type V.
+ * In a header:           DECLARE_HASHMAP(wordCounts, stringConst, int)
+ * and in one .c file:    DEFINE_HASHMAP(wordCounts, stringConst, int, strHash, streq)
+ * where hash(k) returns a ulong, and eq(k1,k2) whether two keys are the same (either may be a function or a macro).
+ * That gives the type `wordCounts`, and:
+ *
+ * void name_init( name* m )                   Make m empty.  (Needed before any other use.)
+ * void name_free( name* m )                   Release m's storage (but not the keys/values themselves);  m is left empty.
+ * V*   name_get( const name* m, K key )       A pointer to key's value, or NULL if key isn't in m.
+ *                                             (Valid only until m is next changed.)
+ * bool name_put( name* m, K key, V val )      Set key's value.  Return whether key is new (rather than replacing a value).
+ * bool name_remove( name* m, K key )          Remove key.  Return whether it had been there.
+ * void name_reserve( name* m, size_t n )      Make room for n entries in all, without further resizing.
+ *
+ * The map stores K and V by value (so for string keys, it's the caller's job to keep the strings around).
+ * To visit every entry (in no particular order):
+ *    for (size_t i=0;  i<m.cap;  ++i) { if (m.hashes[i] != 0) { ... m.entries[i].key ... m.entries[i].val ... } }
+ *
+ * Layout:  a compact array of 32-bit hashes (0 for an empty slot), alongside an array of the entries;
+ * a lookup scans the hashes, and compares keys only when the hashes match.
+ * Robin Hood probing (an entry displaces one that is closer to its home slot) keeps probe-sequences short, and
+ * lets a failed lookup stop early.  Removing shifts the following entries back, so there are no tombstones.
  */
-int* fillArrayI_rand( int* arr, uint sz, int lo, int hi );
+#define DECLARE_HASHMAP(name,K,V) \
+typedef struct { K key;  V val; } name##_entry; \
+typedef struct { \
+    uint32_t*     hashes;  /* 0 for an empty slot */ \
+    name##_entry* entries; \
+    size_t len; \
+    size_t cap;  /* 0, or a power of 2 */ \
+    } name; \
+void name##_init( name* m ); \
+void name##_free( name* m ); \
+V*   name##_get( const name* m, K key ); \
+bool name##_put( name* m, K key, V val ); \
+bool name##_remove( name* m, K key ); \
+void name##_reserve( name* m, size_t n );
+
+/* (Helpers for DEFINE_HASHMAP.)  The stored hash is never 0;  a slot's home is its hash mod cap. */
+static inline uint32_t hashmap_hash32( ulong h ) {
+    uint32_t const h32 = (uint32_t)(h ^ (h >> 32));
+    return (h32 == 0) ? 1 : h32;
+    }
+#define HASHMAP_DIST(hash, slot, mask)  (((slot) - ((hash) & (mask))) & (mask))  // how far slot is from hash's home
+#define HASHMAP_MAX_LOAD(cap)  ((cap) - (cap)/8)  // resize once more than 7/8 full
+
+/* The bodies for DECLARE_HASHMAP's functions.  Needs <stdlib.h>. */
+#define DEFINE_HASHMAP(name,K,V,hashFunc,eqFunc) \
+void name##_init( name* m ) { \
+    m->hashes = NULL; \
+    m->entries = NULL; \
+    m->len = 0; \
+    m->cap = 0; \
+    } \
+void name##_free( name* m ) { \
+    free(m->hashes); \
+    free(m->entries); \
+    name##_init(m); \
+    } \
+/* Put an entry known not to be in m yet (and with room for it). */ \
+static void name##_insertNew( name* m, uint32_t h, name##_entry e ) { \
+    size_t const mask = m->cap - 1; \
+    size_t i = h & mask; \
+    size_t dist = 0; \
+    while (m->hashes[i] != 0) { \
+        size_t const theirDist = HASHMAP_DIST(m->hashes[i], i, mask); \
+        if (theirDist < dist) { /* Robin Hood:  take from the rich (the entry nearer its home) */ \
+            uint32_t const h2 = m->hashes[i];  m->hashes[i] = h;  h = h2; \
+            name##_entry const e2 = m->entries[i];  m->entries[i] = e;  e = e2; \
+            dist = theirDist; \
+            } \
+        i = (i+1) & mask; \
+        ++dist; \
+        } \
+    m->hashes[i] = h; \
+    m->entries[i] = e; \
+    ++m->len; \
+    } \
+static void name##_resize( name* m, size_t newCap ) { \
+    name old = *m; \
+    m->hashes = (uint32_t*) calloc( newCap, sizeof(uint32_t) ); \
+    m->entries = (name##_entry*) malloc( newCap * sizeof(name##_entry) ); \
+    assert(m->hashes != NULL  &&  m->entries != NULL); \
+    m->cap = newCap; \
+    m->len = 0; \
+    for (size_t i=0;  i<old.cap;  ++i) { \
+        if (old.hashes[i] != 0) name##_insertNew( m, old.hashes[i], old.entries[i] ); \
+        } \
+    free(old.hashes); \
+    free(old.entries); \
+    } \
+void name##_reserve( name* m, size_t n ) { \
+    size_t newCap = MAX(m->cap, (size_t)8); \
+    while (HASHMAP_MAX_LOAD(newCap) < n) newCap *= 2; \
+    if (newCap != m->cap) name##_resize(m, newCap); \
+    } \
+/* The slot holding key (with hash h), or m->cap if none. */ \
+static size_t name##_find( const name* m, K key, uint32_t h ) { \
+    if (m->cap == 0) return 0; \
+    size_t const mask = m->cap - 1; \
+    size_t i = h & mask; \
+    for (size_t dist = 0;  ;  ++dist) { \
+        uint32_t const theirs = m->hashes[i]; \
+        if (theirs == 0  ||  HASHMAP_DIST(theirs, i, mask) < dist) return m->cap;  /* (it'd have been placed by now) */ \
+        if (theirs == h  &&  eqFunc(m->entries[i].key, key)) return i; \
+        i = (i+1) & mask; \
+        } \
+    } \
+V* name##_get( const name* m, K key ) { \
+    size_t const i = name##_find( m, key, hashmap_hash32(hashFunc(key)) ); \
+    return (i < m->cap)  ?  &m->entries[i].val  :  NULL; \
+    } \
+bool name##_put( name* m, K key, V val ) { \
+    uint32_t const h = hashmap_hash32(hashFunc(key)); \
+    size_t const i = name##_find( m, key, h ); \
+    if (i < m->cap) { m->entries[i].val = val;  return false; } \
+    if (m->len + 1 > HASHMAP_MAX_LOAD(m->cap)) name##_reserve( m, m->len + 1 ); \
+    name##_entry const e = { key, val }; \
+    name##_insertNew( m, h, e ); \
+    return true; \
+    } \
+bool name##_remove( name* m, K key ) { \
+    size_t i = name##_find( m, key, hashmap_hash32(hashFunc(key)) ); \
+    if (i >= m->cap) return false; \
+    size_t const mask = m->cap - 1; \
+    /* Shift back each following entry that isn't already at its home. */ \
+    size_t next = (i+1) & mask; \
+    while (m->hashes[next] != 0  &&  HASHMAP_DIST(m->hashes[next], next, mask) != 0) { \
+        m->hashes[i] = m->hashes[next]; \
+        m->entries[i] = m->entries[next]; \
+        i = next; \
+        next = (next+1) & mask; \
+        } \
+    m->hashes[i] = 0; \
+    --m->len; \
+    return true; \
+    }
 
 
 
@@ -276,7 +1150,7 @@ int* fillArrayI_rand( int* arr, uint sz, int lo, int hi );
 
 
 // A flag for whether successful test-cases should print a very-short indicator.
-bool print_on_test_success;
+extern bool print_on_test_success;
 
 
 /* Are two values the same?
@@ -290,22 +1164,203 @@ void testUInt( uint actual, uint expected );
 void testLong( long const actual, long const expected );
 void testDouble( double const actual, double const expected );
 void testBool( bool const actual, bool const expected );
+/* Arrays of sz doubles/floats, compared as testDouble;  one test, printing only the first few mismatches. */
+void testDoubleArray( const double* actual, const double* expected, ulong sz );
+void testFloatArray(  const float*  actual, const float*  expected, ulong sz );
 
-// Print any message to the error-log file:
-#define printTestMsg( fmt, args ... ) fprintf(stdout, fmt, ##args)
+// Print any message to the error-log file (stdout; or inside a TEST_CASE, that case's output):
+#define printTestMsg( fmt, args ... ) testMsg(fmt, ##args)
+void testMsg( stringConst fmt, ... ) __attribute__ ((format (printf, 1, 2)));
 
 // Print summary statistics of tests completed/passed.
 void printTestSummary();
+// Zero the counts of tests completed/passed.
+void resetTestSummary();
+// The counts of tests completed/failed, so far (from all threads).
+int testsRun();
+int testsFailed();
+
+
+/* Test cases:  a named group of tests, which runTestCases may run in parallel with other cases.
+ *
+ *    TEST_CASE(modPos) {
+ *        testInt( modPos(-8,3), 1 );
+ *        ...
+ *        }
+ *
+ * TEST_CASE registers itself before main runs (or, call registerTestCase yourself).
+ * Each case's printTestMsg output (including failure messages) is buffered, and printed -- in registration
+ * order, with the case's name, test-count and run-time -- once the case finishes.
+ * The testX functions may be called from any thread.  Cases must not depend on each other.
+ */
+typedef void (*testCaseFunc)( void );
+
+#define TEST_CASE(name) \
+    static void testCase_##name( void ); \
+    __attribute__((constructor)) static void registerTestCase_##name() { registerTestCase(#name, testCase_##name); } \
+    static void testCase_##name( void )
+
+void registerTestCase( stringConst name, testCaseFunc func );
+/* Run every registered case whose name contains `filter` (or all, if NULL), on `numWorkers` threads
+ * (or if 0, one per core).  Return the number of cases with some failed test.
+ */
+int runTestCases( uint numWorkers, stringConst filter );
   
 
+/* Micro-benchmarks.
+ * A benchmark is a function that performs the operation-being-measured `iters` times
+ * (`arg` is passed along unchanged -- e.g. an array-size, for benchmarks registered at several sizes):
+ *
+ *    BENCH(intToString_small) {
+ *        char buf[INT_TO_STRING_MAX_LEN];
+ *        for (ulong i=0;  i<iters;  ++i) { DO_NOT_OPTIMIZE( intToString_into((int)i, buf, sizeof(buf)) ); }
+ *        }
+ *
+ * BENCH registers itself before main runs (or, call registerBench yourself).
+ * runAllBenches calibrates each one's iteration-count, warms it up, times bench_sampleCount samples,
+ * and reports the min, median, and 99th-percentile nanoseconds per iteration.
+ */
+typedef void (*benchFunc)( ulong const iters, long const arg );
+
+#define BENCH(name) \
+    static void bench_##name( ulong const iters, long const arg ); \
+    __attribute__((constructor)) static void registerBench_##name() { registerBench(#name, bench_##name, 0); } \
+    static void bench_##name( ulong const iters, __attribute__((unused)) long const arg )
+
+/* Keep the compiler from optimizing away the computation of `x` (or, for BENCH_CLOBBER, any pending memory-writes),
+ * without the cost of actually storing it anywhere.
+ */
+#define DO_NOT_OPTIMIZE(x)  __asm__ volatile ("" : : "g"(x) : "memory")
+#define BENCH_CLOBBER()     __asm__ volatile ("" : : : "memory")
+
+typedef struct {
+    const char* name;  // not copied; must stay valid as long as the benchmark is registered.
+    benchFunc func;
+    long arg;
+    } benchCase;
+
+typedef struct {
+    char* name;  // the result's own copy (see freeBenchResults)
+    ulong itersPerSample;
+    uint samples;
+    double minNsec, medianNsec, p99Nsec;  // per iteration
+    } benchResult;
+
+extern uint  bench_sampleCount;      // how many timed samples to take (default 31)
+extern ulong bench_sampleNsec;       // the minimum length of one sample; iterations are calibrated to reach it.
+extern ulong bench_warmupNsec;       // how long to run a benchmark before timing it
+extern ulong bench_maxNsecPerBench;  // take fewer samples (but at least 5) if they'd exceed this
+
+void registerBench( stringConst name, benchFunc func, long arg );
+const benchCase* registeredBenches( int* count );
+/* Run one benchmark.  The result's name is a copy, which the caller must free. */
+benchResult runBench( const benchCase* c );
+/* Run every registered benchmark whose name contains `filter` (or all, if `filter` is NULL), in registration order;
+ * print one line per benchmark as it finishes, or (if asJson) one JSON object at the end.
+ * Return the number run.
+ */
+int runAllBenches( stringConst filter, bool const asJson, FILE* f );
+/* Like runAllBenches, but return the results (in a heap-allocated array of *numRun; free it with freeBenchResults).
+ * If `progress` is non-NULL, print each result there as it finishes.
+ */
+benchResult* runBenches( stringConst filter, FILE* progress, int* numRun );
+void printBenchResult( FILE* f, benchResult const r );
+void printBenchResults_json( FILE* f, const benchResult* results, int const n );
+
+/* Register one benchmark per size, named "name/size", each getting its size as `arg`:
+ *
+ *    BENCH_SIZED(arrI_toString, 10, 1000, 100000) {
+ *        ... do something `iters` times, to an array of size `arg` ...
+ *        }
+ */
+void registerBenchSizes( stringConst name, benchFunc func, const long* sizes, int const numSizes );
+#define BENCH_SIZED(name, ...) \
+    static void bench_##name( ulong const iters, long const arg ); \
+    __attribute__((constructor)) static void registerBench_##name() { \
+        static const long sizes[] = { __VA_ARGS__ }; \
+        registerBenchSizes(#name, bench_##name, sizes, (int)SIZEOF_ARRAY(sizes)); \
+        } \
+    static void bench_##name( ulong const iters, long const arg )
+
+/* Read results written by printBenchResults_json (a baseline), into a heap-allocated array of *n;
+ * free it with freeBenchResults.
+ */
+benchResult* readBenchResults_json( FILE* f, int* n );
+/* Free the results, and their names. */
+void freeBenchResults( benchResult* results, int const n );
+/* For each of `current`, print its median vs. the same-named `baseline` one,
+ * flagging changes of more than thresholdPct percent.  Return how many got slower by more than that.
+ */
+int printBenchComparison( FILE* f, const benchResult* baseline, int const nBase,
+                          const benchResult* current, int const nCur, double const thresholdPct );
+
+
 /* Return the #microseconds since the standard epoch. */
 ulong time_usec();
 
+/* Return the #nanoseconds on the monotonic clock, since some arbitrary (fixed) starting point.
+ * Use this (not time_usec) for measuring elapsed time: it never jumps when the wall-clock is adjusted.
+ */
+ulong time_nsec();
+/* Like time_nsec, but cheaper; its resolution is only the kernel's tick (a few ms). */
+ulong time_nsec_coarse();
+
+/* Read the CPU's cycle-counter (x86's time-stamp counter; elsewhere, just time_nsec).
+ * cycles_now_ordered waits for preceding instructions to finish first (rdtscp), for timing the end of a region.
+ * Only differences between readings are meaningful; convert them with cyclesToNsec.
+ */
+ulong cycles_now();
+ulong cycles_now_ordered();
+/* How many cycles per nanosecond.  Measured (against time_nsec, for a few ms) on first use;
+ * call calibrateCycles() at startup to pay that cost up front (or to re-measure).
+ */
+double cycles_perNsec();
+double calibrateCycles();
+ulong cyclesToNsec( ulong const cycles );
+
 
 
 /* Fork and exec the indicated command; returns the fork'd child's ID.
  * No arguments are provided to the exec'd process.
+ * (See spawnProcess, below, for arguments, redirections, and no fork.)
  */
 pid_t forkAndExec( stringConst cmd );
 
+/* Starting a child process, without fork's cost of copying the parent's page tables
+ * (which, for a parent using gigabytes, can take tens of milliseconds per launch) --
+ * and reporting failure to the caller, rather than exiting.
+ *    stringConst args[] = { "sort", "-n", NULL };
+ *    spawnOptions opts;
+ *    spawnOptions_init(&opts);
+ *    opts.redirect[0].path = "numbers.txt";   // the child's stdin
+ *    opts.redirect[1].fd = pipeFds[1];        // the child's stdout
+ *    opts.searchPath = true;                  // find "sort" as the shell would
+ *    pid_t child;
+ *    int const err = spawnProcess(&child, "sort", args, NULL, &opts);
+ *    if (err != 0) fprintf(stderr, "couldn't run sort: %s\n", strerror(err));
+ *    else waitpid(child, &status, 0);
+ */
+typedef struct {
+    int fd;             // if >= 0, the child gets (a duplicate of) this fd;
+    const char* path;   // else if non-NULL, the child gets this file opened:  stdin read-only;
+    bool append;        //   stdout/stderr for writing, created if need be, and truncated (or if `append`, appended to);
+    } spawnRedirect;    // else (the default) it shares the parent's.
+typedef struct {
+    spawnRedirect redirect[3];  // for the child's stdin, stdout, stderr
+    bool searchPath;            // if `cmd` has no '/', look for it in $PATH (as execvp does)
+    } spawnOptions;
+
+/* Set o to the defaults:  the child shares stdin/stdout/stderr with its parent, and `cmd` is a path. */
+void spawnOptions_init( spawnOptions* o );
+
+/* Start `cmd` running in a new process, with arguments argv (NULL-terminated, argv[0] conventionally
+ * the command's name;  or if argv is NULL, just { cmd, NULL }) and environment envp (NULL-terminated
+ * "NAME=value" strings;  or if envp is NULL, the parent's own).  `opts` may be NULL, for the defaults.
+ * Return 0 and set *pid to the child's ID;  or if it couldn't be started (including:  `cmd` or a
+ * redirect's file couldn't be found or opened), return the errno value saying why.
+ * Uses posix_spawn -- which, in glibc, is clone(CLONE_VM|CLONE_VFORK):  the child borrows the parent's
+ * memory until it execs, so the launch time doesn't grow with the parent's size.
+ */
+int spawnProcess( pid_t* pid, stringConst cmd, stringConst argv[], stringConst envp[], const spawnOptions* opts );
+
 #endif